@@ -1,16 +1,41 @@
-#version 120
+#version 130
 
 varying vec2 texCoord;
+varying vec2 tileOffset;
+varying vec3 wallBitsCoord;
 varying float f_use_texture;
 
-uniform sampler2D texture;
+uniform sampler2D maze_texture;
+// set when the texture coordinates count whole tiles, each tile then repeats the quarter of the
+// texture starting at tileOffset
+uniform int repeat_tiles;
+// set for the far quads of the mesh, which blend between the average colors of the floor and the
+// walls by how much of each spot the wall bits cover
+uniform int lod;
+uniform sampler2D wall_bits;
+uniform vec3 floor_color;
+uniform vec3 wall_color;
 
 void main()
 {
 	vec4 final_color = vec4(0.4f, 0.75f, 0.8f, 1.0f);
 
 	if (f_use_texture == 1.0f) {
-		final_color = texture2D(texture, texCoord);
+		if (lod == 1) {
+			// thin walls and poles spread over the pixels around them once they are smaller than a pixel,
+			// so they cover about twice what the wall bits say. sampled before the bottom of the floor is
+			// left out so the mip level is taken from every pixel
+			float covered = min(2.0f * texture2D(wall_bits, wallBitsCoord.xy).r, 1.0f);
+			if (wallBitsCoord.z < -0.5f) { covered = 0.0f; }
+			final_color = vec4(mix(floor_color, wall_color, covered), 1.0f);
+		} else if (repeat_tiles == 1) {
+			// the mip level comes from the unwrapped coordinates, so the jump at each tile edge
+			// doesn't drop to the smallest mip level along a line of pixels
+			final_color = textureGrad(maze_texture, tileOffset + fract(texCoord) * 0.5f,
+				dFdx(texCoord) * 0.5f, dFdy(texCoord) * 0.5f);
+		} else {
+			final_color = texture2D(maze_texture, texCoord);
+		}
 	}
 	gl_FragColor = final_color;
 }
@@ -0,0 +1,113 @@
+#include <stdlib.h>
+#include <string.h>
+#include "maze_arena.h"
+
+// room taken by the block header, so the first allocation of a block is aligned
+#define HEADER_SIZE ((sizeof(maze_arena_block) + MAZE_ARENA_ALIGN - 1) & ~(size_t)(MAZE_ARENA_ALIGN - 1))
+
+// +---------------+
+// |   FUNCTIONS   |
+// +---------------+
+
+static inline size_t align_up(size_t size) {
+	return (size + MAZE_ARENA_ALIGN - 1) & ~(size_t)(MAZE_ARENA_ALIGN - 1);
+}
+
+// put a new block of at least size bytes in front, returns false when out of memory
+static int add_block(maze_arena* arena, size_t size) {
+	size = align_up(size < MAZE_ARENA_BLOCK_SIZE ? MAZE_ARENA_BLOCK_SIZE : size);
+	maze_arena_block* block = aligned_alloc(MAZE_ARENA_ALIGN, HEADER_SIZE + size);
+	if (block == NULL) { return 0; }
+	block->next = arena->blocks;
+	block->size = size;
+	block->used = 0;
+	arena->blocks = block;
+	return 1;
+}
+
+// set up an arena that owns no memory yet
+void maze_arena_init(maze_arena* arena) {
+	arena->blocks = NULL;
+	arena->used = 0;
+	arena->peak = 0;
+}
+
+// give all memory of an arena back to the heap
+void maze_arena_free(maze_arena* arena) {
+	while (arena->blocks != NULL) {
+		maze_arena_block* next = arena->blocks->next;
+		free(arena->blocks);
+		arena->blocks = next;
+	}
+	maze_arena_init(arena);
+}
+
+// release everything allocated from an arena at once, the memory is kept for the next maze
+void maze_arena_reset(maze_arena* arena) {
+	size_t peak = (arena->used > arena->peak) ? arena->used : arena->peak;
+
+	// a maze that needed several blocks gets one block big enough for all of it next time
+	if (arena->blocks != NULL && arena->blocks->next != NULL) {
+		size_t total = 0;
+		for (maze_arena_block* block = arena->blocks; block != NULL; block = block->next) { total += block->size; }
+		maze_arena_free(arena);
+		add_block(arena, total);
+	}
+	if (arena->blocks != NULL) { arena->blocks->used = 0; }
+	arena->used = 0;
+	arena->peak = peak;
+}
+
+// size bytes from the arena, NULL when out of memory
+void* maze_arena_alloc(maze_arena* arena, size_t size) {
+	size = align_up(size == 0 ? 1 : size);
+	maze_arena_block* block = arena->blocks;
+	if (block == NULL || block->size - block->used < size) {
+		if (!add_block(arena, size)) { return NULL; }
+		block = arena->blocks;
+	}
+
+	void* memory = (char*)block + HEADER_SIZE + block->used;
+	block->used += size;
+	arena->used += size;
+	return memory;
+}
+
+void* maze_alloc(maze_arena* arena, size_t size) {
+	if (arena == NULL) { return malloc(size); }
+	return maze_arena_alloc(arena, size);
+}
+
+void* maze_calloc(maze_arena* arena, size_t count, size_t size) {
+	if (arena == NULL) { return calloc(count, size); }
+
+	// arena memory is reused from earlier mazes, so it has to be cleared by hand
+	void* memory = maze_arena_alloc(arena, count * size);
+	if (memory != NULL) { memset(memory, 0, count * size); }
+	return memory;
+}
+
+void* maze_realloc(maze_arena* arena, void* memory, size_t old_size, size_t size) {
+	if (arena == NULL) { return realloc(memory, size); }
+	if (memory == NULL) { return maze_arena_alloc(arena, size); }
+	if (size <= old_size) { return memory; }
+
+	// the last allocation of the current block can grow in place
+	maze_arena_block* block = arena->blocks;
+	char* end = (char*)block + HEADER_SIZE + block->used;
+	if ((char*)memory + align_up(old_size) == end && align_up(size) - align_up(old_size) <= block->size - block->used) {
+		size_t grow = align_up(size) - align_up(old_size);
+		block->used += grow;
+		arena->used += grow;
+		return memory;
+	}
+
+	void* grown = maze_arena_alloc(arena, size);
+	if (grown != NULL) { memcpy(grown, memory, old_size < size ? old_size : size); }
+	return grown;
+}
+
+// arena memory is only released by maze_arena_reset, so this does nothing for it
+void maze_release(maze_arena* arena, void* memory) {
+	if (arena == NULL) { free(memory); }
+}
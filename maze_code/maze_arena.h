@@ -0,0 +1,70 @@
+#ifndef _MAZE_ARENA_H_
+#define _MAZE_ARENA_H_
+
+#include <stddef.h>
+
+// +----------------------------------------------------------------------+
+// |                                                                      |
+// |                              ARENAS                                  |
+// |                                                                      |
+// +----------------------------------------------------------------------+
+
+// everything that lives as long as one maze, the grid, the solver scratch, the path and the
+// geometry, can come out of one arena. allocating is a pointer bump, nothing is freed on its
+// own, and the whole maze goes away with one reset. a reset keeps the memory and merges it into
+// one block, so every maze after the first of its size never touches the heap at all
+
+// every allocation starts on its own cache line
+#define MAZE_ARENA_ALIGN 64
+// smallest block asked of the heap at a time
+#define MAZE_ARENA_BLOCK_SIZE ((size_t)1 << 20)
+
+// +---------------------+
+// |   TYPE DEFINITION   |
+// +---------------------+
+
+// one piece of heap memory, the allocations follow the header
+typedef struct maze_arena_block {
+	struct maze_arena_block* next;
+	size_t size;
+	size_t used;
+} maze_arena_block;
+
+typedef struct {
+	// newest block first, allocations only ever come out of the first one
+	maze_arena_block* blocks;
+
+	// bytes handed out since the last reset, and the most ever handed out between two resets
+	size_t used;
+	size_t peak;
+} maze_arena;
+
+// +---------------+
+// |   FUNCTIONS   |
+// +---------------+
+
+// set up an arena that owns no memory yet
+void maze_arena_init(maze_arena* arena);
+// give all memory of an arena back to the heap
+void maze_arena_free(maze_arena* arena);
+// release everything allocated from an arena at once, the memory is kept for the next maze
+void maze_arena_reset(maze_arena* arena);
+
+// size bytes from the arena, NULL when out of memory
+void* maze_arena_alloc(maze_arena* arena, size_t size);
+
+// +-------------------------+
+// |   ARENA OR HEAP MEMORY  |
+// +-------------------------+
+
+// structs that can live in an arena keep a maze_arena* that is NULL for plain heap memory and
+// allocate through these, which go to the arena or to malloc, calloc, realloc and free
+
+void* maze_alloc(maze_arena* arena, size_t size);
+void* maze_calloc(maze_arena* arena, size_t count, size_t size);
+// old_size is only needed for arena memory, which is grown in place when it was the last allocation
+void* maze_realloc(maze_arena* arena, void* memory, size_t old_size, size_t size);
+// arena memory is only released by maze_arena_reset, so this does nothing for it
+void maze_release(maze_arena* arena, void* memory);
+
+#endif
@@ -0,0 +1,151 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "maze_batch.h"
+#include "maze_context.h"
+#include "maze_gen.h"
+#include "maze_file.h"
+#include "maze_packed.h"
+#include "maze_search.h"
+#include "maze_thread.h"
+
+// shared state of the batch workers
+typedef struct {
+	const maze_batch_options* options;
+	FILE* out;
+	pthread_mutex_t out_lock;
+
+	atomic_int next_maze;
+	atomic_llong total_path_length;
+	atomic_llong total_expanded;
+	atomic_llong solve_nanoseconds;
+	atomic_int failed;
+} batch_job;
+
+// letter of each direction for writing out solutions
+static const char direction_letters[] = " NESW";
+
+// write one maze and its solution, the caller holds the output lock
+static bool write_maze(FILE* out, int index, unsigned long long seed, const maze_grid* grid,
+		const char* algorithm, const maze_path* path) {
+	fprintf(out, "maze %i seed %llu size %ix%i algorithm %s path %lli\n",
+		index, seed, grid->width, grid->height, algorithm, path->length);
+	if (!maze_grid_print(grid, out)) { return false; }
+
+	// the direction each cell of the path was entered from, starting at the entrance
+	for (long long i = 0; i < path->length; ++i) {
+		fputc(direction_letters[path->steps[i].orientation], out);
+	}
+	fputc('\n', out);
+	return !ferror(out);
+}
+
+// worker that keeps taking the next maze until the whole batch is done
+static void batch_worker(int worker, void* task_data) {
+	// workers take mazes off the shared counter, so which worker this is doesn't matter
+	(void)worker;
+	batch_job* job = task_data;
+	const maze_batch_options* options = job->options;
+
+	// every worker works on its own context, whose arena is reset between mazes so after the first
+	// maze a worker never touches the heap for the grid, path and search buffers again
+	maze_context context;
+	maze_context_init(&context);
+	context.width = options->width;
+	context.height = options->height;
+	context.layout = options->layout;
+	context.algorithm = options->algorithm;
+	context.solver = options->solver;
+	// the batch is already spread over the workers, so each maze is generated and solved on one thread
+	context.num_threads = 1;
+	const maze_grid* grid = &context.grid;
+	const maze_path* path = &context.path;
+	maze_packed_path packed;
+	maze_packed_init(&packed);
+
+	while (!atomic_load(&job->failed)) {
+		int index = atomic_fetch_add(&job->next_maze, 1);
+		if (index >= options->count) { break; }
+
+		unsigned long long seed = options->seed + index;
+		context.seed = seed;
+		if (!maze_context_generate(&context)) {
+			atomic_store(&job->failed, 1);
+			break;
+		}
+
+		struct timespec solve_start, solve_end;
+		clock_gettime(CLOCK_MONOTONIC, &solve_start);
+		if (!maze_context_solve(&context)) {
+			atomic_store(&job->failed, 1);
+			break;
+		}
+		clock_gettime(CLOCK_MONOTONIC, &solve_end);
+		atomic_fetch_add(&job->solve_nanoseconds, (solve_end.tv_sec - solve_start.tv_sec) * 1000000000LL
+			+ (solve_end.tv_nsec - solve_start.tv_nsec));
+		atomic_fetch_add(&job->total_path_length, path->length);
+		atomic_fetch_add(&job->total_expanded, context.search.expanded);
+
+		if (job->out != NULL) {
+			pthread_mutex_lock(&job->out_lock);
+			bool written = write_maze(job->out, index, seed, grid,
+				maze_algorithm_name(options->algorithm), path);
+			pthread_mutex_unlock(&job->out_lock);
+			if (!written) { atomic_store(&job->failed, 1); }
+		}
+
+		if (options->binary_prefix != NULL) {
+			char path_name[4096];
+			snprintf(path_name, sizeof(path_name), "%s%i.maze", options->binary_prefix, index);
+			if (!maze_file_save(path_name, grid, seed, options->algorithm)) { atomic_store(&job->failed, 1); }
+
+			snprintf(path_name, sizeof(path_name), "%s%i.path", options->binary_prefix, index);
+			FILE* path_file = fopen(path_name, "wb");
+			bool saved = path_file != NULL && maze_packed_from_path(&packed, path)
+				&& maze_packed_write(path_file, &packed);
+			if (path_file != NULL && fclose(path_file) != 0) { saved = false; }
+			if (!saved) { atomic_store(&job->failed, 1); }
+		}
+	}
+
+	maze_packed_free(&packed);
+	maze_context_free(&context);
+}
+
+// generate and solve options->count mazes on options->num_threads worker threads
+bool run_maze_batch(const maze_batch_options* options, maze_batch_result* result) {
+	batch_job job;
+	job.options = options;
+	job.out = NULL;
+	pthread_mutex_init(&job.out_lock, NULL);
+	atomic_init(&job.next_maze, 0);
+	atomic_init(&job.total_path_length, 0);
+	atomic_init(&job.total_expanded, 0);
+	atomic_init(&job.solve_nanoseconds, 0);
+	atomic_init(&job.failed, 0);
+
+	if (options->output_path != NULL) {
+		job.out = fopen(options->output_path, "w");
+		if (job.out == NULL) { return false; }
+	}
+
+	int num_threads = (options->num_threads < 1) ? 1 : options->num_threads;
+
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	maze_parallel_for(num_threads, num_threads, batch_worker, &job);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	result->seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	result->total_path_length = atomic_load(&job.total_path_length);
+	result->solve_seconds = atomic_load(&job.solve_nanoseconds) / 1e9;
+	result->total_expanded = atomic_load(&job.total_expanded);
+
+	if (job.out != NULL && fclose(job.out) != 0) {
+		atomic_store(&job.failed, 1);
+	}
+	pthread_mutex_destroy(&job.out_lock);
+	return !atomic_load(&job.failed);
+}
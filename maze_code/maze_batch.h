@@ -0,0 +1,56 @@
+#ifndef _MAZE_BATCH_H_
+#define _MAZE_BATCH_H_
+
+#include "maze_grid.h"
+
+// +----------------------------------------------------------------------+
+// |                                                                      |
+// |                              BATCH                                   |
+// |                                                                      |
+// +----------------------------------------------------------------------+
+
+// headless generation and solving of many mazes, never touches GLUT or GL
+
+// +---------------------+
+// |   TYPE DEFINITION   |
+// +---------------------+
+
+typedef struct {
+	int width;
+	int height;
+	int count;
+	int num_threads;
+	int algorithm;
+	// MAZE_LAYOUT_* of the grids the mazes are generated in
+	int layout;
+	// MAZE_SOLVER_* used to solve every maze
+	int solver;
+
+	// maze i is generated from seed + i, so any maze of a batch can be replayed on its own
+	unsigned long long seed;
+
+	// every maze and its solution is written here, NULL to only run the benchmark
+	const char* output_path;
+	// maze i is also saved as the binary maze file <binary_prefix><i>.maze and its solution as
+	// the packed path file <binary_prefix><i>.path, NULL to skip
+	const char* binary_prefix;
+} maze_batch_options;
+
+typedef struct {
+	double seconds;
+	long long total_path_length;
+
+	// time spent solving, added up over the workers, and cells the solver expanded in all mazes
+	double solve_seconds;
+	long long total_expanded;
+} maze_batch_result;
+
+// +---------------+
+// |   FUNCTIONS   |
+// +---------------+
+
+// generate and solve options->count mazes on options->num_threads worker threads,
+// returns false when out of memory or when the output couldn't be written
+bool run_maze_batch(const maze_batch_options* options, maze_batch_result* result);
+
+#endif
@@ -0,0 +1,93 @@
+#include <stdlib.h>
+#include "maze_context.h"
+#include "maze_gen.h"
+
+// +---------------+
+// |   FUNCTIONS   |
+// +---------------+
+
+// set up a context with the default settings
+void maze_context_init(maze_context* context) {
+	context->width = 8;
+	context->height = 8;
+	context->layout = MAZE_LAYOUT_ROW_MAJOR;
+	context->algorithm = MAZE_ALGORITHM_BACKTRACKER;
+	context->solver = MAZE_SOLVER_WALL;
+	context->num_threads = 1;
+	context->seed = 0;
+
+	maze_arena_init(&context->arena);
+	maze_rng_seed(&context->rng, context->seed);
+
+	context->grid.south_walls = NULL;
+	context->grid.east_walls = NULL;
+	context->grid.visited = NULL;
+	context->grid.arena = &context->arena;
+	maze_path_init_arena(&context->path, &context->arena);
+	maze_search_init_arena(&context->search, &context->arena);
+	context->editor_ready = false;
+	maze_geometry_init_arena(&context->geometry, &context->arena);
+}
+
+// drop the old maze and everything built from it, then empty the arena for the next one
+static void start_maze(maze_context* context) {
+	if (context->editor_ready) {
+		maze_edit_free(&context->editor);
+		context->editor_ready = false;
+	}
+	maze_geometry_free(&context->geometry);
+	maze_search_free(&context->search);
+
+	maze_arena_reset(&context->arena);
+	maze_path_init_arena(&context->path, &context->arena);
+	maze_search_init_arena(&context->search, &context->arena);
+	maze_geometry_init_arena(&context->geometry, &context->arena);
+}
+
+// release everything held by a context
+void maze_context_free(maze_context* context) {
+	start_maze(context);
+	context->grid.south_walls = NULL;
+	context->grid.east_walls = NULL;
+	context->grid.visited = NULL;
+	maze_arena_free(&context->arena);
+}
+
+// throw away the current maze and generate a new one from the settings
+bool maze_context_generate(maze_context* context) {
+	start_maze(context);
+	maze_rng_seed(&context->rng, context->seed);
+
+	if (!maze_grid_init_arena(&context->grid, context->width, context->height, context->layout, &context->arena)) {
+		return false;
+	}
+	return generate_maze_with(&context->grid, &context->rng, context->algorithm, context->num_threads);
+}
+
+// throw away the current maze and copy one out of a maze file
+bool maze_context_load(maze_context* context, const maze_file* file) {
+	start_maze(context);
+	context->seed = file->header->seed;
+	context->algorithm = file->header->algorithm;
+	maze_rng_seed(&context->rng, context->seed);
+
+	if (!maze_file_load(file, &context->grid, context->layout, &context->arena)) { return false; }
+	context->width = context->grid.width;
+	context->height = context->grid.height;
+	return true;
+}
+
+// solve the maze with the solver from the settings
+bool maze_context_solve(maze_context* context) {
+	context->search.num_threads = context->num_threads;
+	return maze_search_solve(&context->search, &context->grid, context->solver, &context->path);
+}
+
+// open or close the wall on the given side of a cell and bring the path up to date with maze_edit
+bool maze_context_set_wall(maze_context* context, int row, int col, int direction, bool wall) {
+	if (!context->editor_ready) {
+		if (!maze_edit_init(&context->editor, &context->grid, &context->path)) { return false; }
+		context->editor_ready = true;
+	}
+	return maze_edit_set_wall(&context->editor, row, col, direction, wall);
+}
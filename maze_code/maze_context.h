@@ -0,0 +1,77 @@
+#ifndef _MAZE_CONTEXT_H_
+#define _MAZE_CONTEXT_H_
+
+#include "maze_grid.h"
+#include "maze_rng.h"
+#include "maze_solve.h"
+#include "maze_search.h"
+#include "maze_edit.h"
+#include "maze_file.h"
+#include "maze_geometry.h"
+
+// +----------------------------------------------------------------------+
+// |                                                                      |
+// |                              CONTEXT                                 |
+// |                                                                      |
+// +----------------------------------------------------------------------+
+
+// everything that belongs to one maze: its settings, the grid, its solution, the editor and the
+// geometry. the library keeps no state of its own, so every thread can work on its own context at
+// the same time. a context points into itself, so it must stay where it is once it is set up
+
+// +---------------------+
+// |   TYPE DEFINITION   |
+// +---------------------+
+
+typedef struct {
+	// settings, filled in by the caller before generating
+	int width;
+	int height;
+	// MAZE_LAYOUT_*, MAZE_ALGORITHM_* and MAZE_SOLVER_*
+	int layout;
+	int algorithm;
+	int solver;
+	// threads used for generating and solving this one maze
+	int num_threads;
+	// seed for maze generation, kept so a maze can be replayed
+	unsigned long long seed;
+
+	// owns the grid, the path, the search buffers and the vertices, reset for every new maze
+	maze_arena arena;
+	// seeded for generation, then keeps going for anything random done to the maze afterwards
+	maze_rng rng;
+
+	maze_grid grid;
+	maze_path path;
+	maze_search search;
+
+	// keeps the path up to date as walls are opened and closed, set up on the first edit
+	maze_edit editor;
+	bool editor_ready;
+
+	maze_geometry geometry;
+} maze_context;
+
+// +---------------+
+// |   FUNCTIONS   |
+// +---------------+
+
+// set up a context with the default settings, an 8x8 maze of the backtracker solved by the wall follower
+void maze_context_init(maze_context* context);
+// release everything held by a context
+void maze_context_free(maze_context* context);
+
+// throw away the current maze and generate a new one from the settings, returns false when out of memory
+bool maze_context_generate(maze_context* context);
+// throw away the current maze and copy one out of a maze file, the dimensions, seed and algorithm
+// are taken from the file. returns false when out of memory
+bool maze_context_load(maze_context* context, const maze_file* file);
+
+// solve the maze with the solver from the settings, returns false when out of memory
+bool maze_context_solve(maze_context* context);
+
+// open or close the wall on the given side of a cell and bring the path up to date with maze_edit,
+// returns false when the wall didn't change or when out of memory
+bool maze_context_set_wall(maze_context* context, int row, int col, int direction, bool wall);
+
+#endif
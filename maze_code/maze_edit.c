@@ -0,0 +1,273 @@
+#include <stdlib.h>
+#include <string.h>
+#include "maze_edit.h"
+
+// +---------------+
+// |   FUNCTIONS   |
+// +---------------+
+
+// row major index of the neighbor of a cell in the given direction
+static inline uint32_t neighbor(const maze_grid* grid, uint32_t cell, int direction) {
+	switch (direction) {
+		case north: return cell - grid->width;
+		case east: return cell + 1;
+		case south: return cell + grid->width;
+		default: return cell - 1;
+	}
+}
+
+// release the memory held by an editor, the grid and path are left alone
+void maze_edit_free(maze_edit* edit) {
+	free(edit->distances);
+	free(edit->toward);
+	free(edit->stamp);
+	free(edit->list);
+	free(edit->queue);
+	free(edit->seeds);
+	edit->distances = NULL;
+	edit->toward = NULL;
+	edit->stamp = NULL;
+	edit->list = NULL;
+	edit->queue = NULL;
+	edit->seeds = NULL;
+	edit->cells = 0;
+}
+
+// walk from the entrance to the exit and write the path over the old one, noting the first step
+// that differs. returns false when out of memory
+static bool rebuild_path(maze_edit* edit) {
+	const maze_grid* grid = edit->grid;
+	maze_path* path = edit->path;
+	long long old_length = path->length;
+
+	if (edit->distances[0] == MAZE_EDIT_UNREACHED) {
+		path->length = 0;
+		edit->first_change = 0;
+		return true;
+	}
+
+	long long length = (long long)edit->distances[0] + 1;
+	if (!maze_path_reserve(path, length)) { return false; }
+
+	// both paths end at the exit, so a path that matches all the way along is the same path
+	edit->first_change = length;
+	uint32_t cell = 0;
+	int orientation = south;
+	for (long long i = 0; i < length; ++i) {
+		maze_step* step = &path->steps[i];
+		int row = cell / grid->width;
+		int col = cell % grid->width;
+		if (edit->first_change == length && (i >= old_length || step->row != row || step->col != col
+				|| step->orientation != orientation)) {
+			edit->first_change = i;
+		}
+
+		step->row = row;
+		step->col = col;
+		step->orientation = orientation;
+		orientation = edit->toward[cell];
+		cell = neighbor(grid, cell, orientation);
+	}
+	path->length = length;
+	return true;
+}
+
+// breadth first from a cell whose distance just went down, lowering the distance of every cell it
+// now gives a shorter way out. returns the number of cells lowered, the first one included
+static long long spread(maze_edit* edit, uint32_t first) {
+	const maze_grid* grid = edit->grid;
+	size_t head = 0;
+	size_t tail = 0;
+	edit->queue[tail++] = first;
+
+	// the queue only ever holds one distance and the next, so no cell is lowered twice
+	while (head < tail) {
+		uint32_t cell = edit->queue[head++];
+		uint32_t distance = edit->distances[cell] + 1;
+		int row = cell / grid->width;
+		int col = cell % grid->width;
+		for (int direction = north; direction <= west; ++direction) {
+			if (!maze_can_move(grid, row, col, direction)) { continue; }
+			uint32_t next = neighbor(grid, cell, direction);
+			if (edit->distances[next] <= distance) { continue; }
+			edit->distances[next] = distance;
+			edit->toward[next] = (direction + 1) % 4 + 1;
+			edit->queue[tail++] = next;
+		}
+	}
+	return tail;
+}
+
+// solve a grid from scratch and keep the path from the entrance to the exit in path from now on
+bool maze_edit_init(maze_edit* edit, maze_grid* grid, maze_path* path) {
+	edit->grid = grid;
+	edit->path = path;
+	edit->cells = (size_t)grid->width * grid->height;
+	edit->generation = 0;
+	edit->distances = NULL;
+	edit->toward = NULL;
+	edit->stamp = NULL;
+	edit->list = NULL;
+	edit->queue = NULL;
+	edit->seeds = NULL;
+	if (edit->cells > (size_t)UINT32_MAX) { return false; }
+
+	edit->distances = malloc(edit->cells * sizeof(uint32_t));
+	edit->toward = calloc(edit->cells, sizeof(uint8_t));
+	edit->stamp = calloc(edit->cells, sizeof(uint32_t));
+	edit->list = malloc(edit->cells * sizeof(uint32_t));
+	edit->queue = malloc(edit->cells * sizeof(uint32_t));
+	edit->seeds = malloc(edit->cells * sizeof(uint64_t));
+	if (edit->distances == NULL || edit->toward == NULL || edit->stamp == NULL
+			|| edit->list == NULL || edit->queue == NULL || edit->seeds == NULL) {
+		maze_edit_free(edit);
+		return false;
+	}
+
+	memset(edit->distances, 0xff, edit->cells * sizeof(uint32_t));
+	edit->distances[edit->cells - 1] = 0;
+	edit->touched = spread(edit, edit->cells - 1);
+	if (!rebuild_path(edit)) {
+		maze_edit_free(edit);
+		return false;
+	}
+	return true;
+}
+
+static int compare_seeds(const void* a, const void* b) {
+	uint64_t first = *(const uint64_t*)a;
+	uint64_t second = *(const uint64_t*)b;
+	return (first > second) - (first < second);
+}
+
+// the step from cell to its neighbor was just walled off, so every cell whose way out went through
+// it has to find a new one. only those cells are stamped, given the best way out through a cell
+// that kept its way, and then solved in order of distance. returns the number of cells cut off
+static long long cut_off(maze_edit* edit, uint32_t cell) {
+	const maze_grid* grid = edit->grid;
+	if (++edit->generation == 0) {
+		memset(edit->stamp, 0, edit->cells * sizeof(uint32_t));
+		edit->generation = 1;
+	}
+	uint32_t generation = edit->generation;
+
+	// gather the cells that hung off the closed step by following the tree backwards
+	size_t count = 0;
+	edit->list[count++] = cell;
+	edit->stamp[cell] = generation;
+	for (size_t i = 0; i < count; ++i) {
+		uint32_t here = edit->list[i];
+		int row = here / grid->width;
+		int col = here % grid->width;
+		for (int direction = north; direction <= west; ++direction) {
+			if ((direction == north && row == 0) || (direction == south && row == grid->height - 1)
+					|| (direction == west && col == 0) || (direction == east && col == grid->width - 1)) {
+				continue;
+			}
+			uint32_t next = neighbor(grid, here, direction);
+			if (edit->toward[next] != (direction + 1) % 4 + 1 || edit->stamp[next] == generation) { continue; }
+			edit->stamp[next] = generation;
+			edit->list[count++] = next;
+		}
+	}
+	for (size_t i = 0; i < count; ++i) {
+		edit->distances[edit->list[i]] = MAZE_EDIT_UNREACHED;
+		edit->toward[edit->list[i]] = 0;
+	}
+
+	// start every cut off cell at its best neighbor outside, those distances can't have changed
+	size_t num_seeds = 0;
+	for (size_t i = 0; i < count; ++i) {
+		uint32_t here = edit->list[i];
+		int row = here / grid->width;
+		int col = here % grid->width;
+		for (int direction = north; direction <= west; ++direction) {
+			if (!maze_can_move(grid, row, col, direction)) { continue; }
+			uint32_t next = neighbor(grid, here, direction);
+			if (edit->stamp[next] == generation || edit->distances[next] == MAZE_EDIT_UNREACHED) { continue; }
+			if (edit->distances[next] + 1 < edit->distances[here]) {
+				edit->distances[here] = edit->distances[next] + 1;
+				edit->toward[here] = direction;
+			}
+		}
+		if (edit->distances[here] != MAZE_EDIT_UNREACHED) {
+			edit->seeds[num_seeds++] = (uint64_t)edit->distances[here] << 32 | here;
+		}
+	}
+	qsort(edit->seeds, num_seeds, sizeof(uint64_t), compare_seeds);
+
+	// take cells in order of distance from the sorted seeds and from a queue of the cells they lower,
+	// which also comes out in order of distance, and skip seeds lowered since they were sorted
+	size_t next_seed = 0;
+	size_t head = 0;
+	size_t tail = 0;
+	while (next_seed < num_seeds || head < tail) {
+		uint32_t here;
+		if (head < tail && (next_seed == num_seeds
+				|| edit->distances[edit->queue[head]] <= (edit->seeds[next_seed] >> 32))) {
+			here = edit->queue[head++];
+		} else {
+			uint64_t seed = edit->seeds[next_seed++];
+			here = (uint32_t)seed;
+			if ((seed >> 32) != edit->distances[here]) { continue; }
+		}
+
+		uint32_t distance = edit->distances[here] + 1;
+		int row = here / grid->width;
+		int col = here % grid->width;
+		for (int direction = north; direction <= west; ++direction) {
+			if (!maze_can_move(grid, row, col, direction)) { continue; }
+			uint32_t next = neighbor(grid, here, direction);
+			if (edit->stamp[next] != generation || edit->distances[next] <= distance) { continue; }
+			edit->distances[next] = distance;
+			edit->toward[next] = (direction + 1) % 4 + 1;
+			edit->queue[tail++] = next;
+		}
+	}
+	return count;
+}
+
+// open or close the wall on the given side of a cell and bring the distances and path up to date
+bool maze_edit_set_wall(maze_edit* edit, int row, int col, int direction, bool wall) {
+	maze_grid* grid = edit->grid;
+	if (row < 0 || row >= grid->height || col < 0 || col >= grid->width) { return false; }
+	if ((direction == north && row == 0) || (direction == south && row == grid->height - 1)
+			|| (direction == west && col == 0) || (direction == east && col == grid->width - 1)) {
+		return false;
+	}
+	if (maze_has_wall(grid, row, col, direction) == wall) { return false; }
+
+	uint32_t cell = (uint32_t)row * grid->width + col;
+	uint32_t next = neighbor(grid, cell, direction);
+	int back = (direction + 1) % 4 + 1;
+	uint32_t entrance_distance = edit->distances[0];
+	bool entrance_cut_off = false;
+	edit->touched = 0;
+
+	if (wall) {
+		maze_add_wall(grid, row, col, direction);
+
+		// walls no way out went through change nothing
+		if (edit->toward[cell] == direction) { edit->touched = cut_off(edit, cell); }
+		else if (edit->toward[next] == back) { edit->touched = cut_off(edit, next); }
+		entrance_cut_off = edit->touched > 0 && edit->stamp[0] == edit->generation;
+	} else {
+		maze_remove_wall(grid, row, col, direction);
+
+		// only the side that is now closer to the exit spreads out
+		if (edit->distances[next] != MAZE_EDIT_UNREACHED && edit->distances[next] + 1 < edit->distances[cell]) {
+			edit->distances[cell] = edit->distances[next] + 1;
+			edit->toward[cell] = direction;
+			edit->touched = spread(edit, cell);
+		} else if (edit->distances[cell] != MAZE_EDIT_UNREACHED && edit->distances[cell] + 1 < edit->distances[next]) {
+			edit->distances[next] = edit->distances[cell] + 1;
+			edit->toward[next] = back;
+			edit->touched = spread(edit, next);
+		}
+	}
+
+	// the path only changes when the entrance lost its way out or found a shorter one
+	edit->first_change = edit->path->length;
+	if (entrance_cut_off || edit->distances[0] != entrance_distance) { return rebuild_path(edit); }
+	return true;
+}
@@ -0,0 +1,70 @@
+#ifndef _MAZE_EDIT_H_
+#define _MAZE_EDIT_H_
+
+#include "maze_grid.h"
+#include "maze_solve.h"
+
+// +----------------------------------------------------------------------+
+// |                                                                      |
+// |                              EDITING                                 |
+// |                                                                      |
+// +----------------------------------------------------------------------+
+
+// walls opened and closed at runtime with the solution kept up to date. every cell keeps its
+// distance to the exit and the direction of its next step there, so the steps form a tree rooted
+// at the exit. opening a wall only spreads out from the cell it made closer, and closing a wall
+// only solves again the part of the tree that hung off the closed side, the rest is never touched
+
+// distance of cells that can't reach the exit
+#define MAZE_EDIT_UNREACHED UINT32_MAX
+
+// +---------------------+
+// |   TYPE DEFINITION   |
+// +---------------------+
+
+typedef struct {
+	maze_grid* grid;
+	maze_path* path;
+	size_t cells;
+
+	// steps from every row major cell to the exit, and the direction of the first of them.
+	// the exit and unreached cells have no direction, stored as 0
+	uint32_t* distances;
+	uint8_t* toward;
+
+	// cells cut off by a closed wall are stamped with the current generation
+	uint32_t* stamp;
+	uint32_t generation;
+	// scratch lists of cells, and (distance << 32 | cell) entries sorted when solving again
+	uint32_t* list;
+	uint32_t* queue;
+	uint64_t* seeds;
+
+	// cells whose distance was looked at again by the last edit
+	long long touched;
+	// first step of the path that changed in the last edit, path->length when none did
+	long long first_change;
+} maze_edit;
+
+// +---------------+
+// |   FUNCTIONS   |
+// +---------------+
+
+// solve a grid from scratch and keep the path from the entrance to the exit in path from now on,
+// the start cell is marked as entered heading south like in solve_maze. the path is empty while
+// the exit can't be reached. returns false when out of memory
+bool maze_edit_init(maze_edit* edit, maze_grid* grid, maze_path* path);
+// release the memory held by an editor, the grid and path are left alone
+void maze_edit_free(maze_edit* edit);
+
+// open or close the wall on the given side of a cell and bring the distances and path up to date.
+// walls of the outer border can't be edited. returns false when the wall is on the border, when it
+// already was that way or when out of memory
+bool maze_edit_set_wall(maze_edit* edit, int row, int col, int direction, bool wall);
+
+// steps from a cell to the exit, MAZE_EDIT_UNREACHED when there is no way there
+static inline uint32_t maze_edit_distance(const maze_edit* edit, int row, int col) {
+	return edit->distances[(size_t)row * edit->grid->width + col];
+}
+
+#endif
@@ -0,0 +1,194 @@
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "maze_file.h"
+
+// +---------------+
+// |   FUNCTIONS   |
+// +---------------+
+
+// walk over every word of every tile in file order, copying between the tiles and the grid one band
+// of tile rows at a time so the grid can be in any layout. words that lie outside of the grid are
+// filled with walls when saving. returns false when out of memory
+static bool copy_tiles(const maze_file_header* header, uint64_t* tiles, maze_grid* grid, bool saving) {
+	// a band never holds more rows than the grid has
+	size_t band_capacity = (header->tile_rows < (uint32_t)grid->height) ? header->tile_rows : (size_t)grid->height;
+	size_t band_words = band_capacity * grid->words_per_row;
+	uint64_t* band = malloc(2 * band_words * sizeof(uint64_t));
+	if (band == NULL) { return false; }
+	uint64_t* tile_word = tiles;
+
+	for (uint64_t tile_row = 0; tile_row < header->tiles_down; ++tile_row) {
+		size_t first_row = tile_row * header->tile_rows;
+		if (first_row >= (size_t)grid->height) { break; }
+		size_t band_rows = header->tile_rows;
+		if (first_row + band_rows > (size_t)grid->height) { band_rows = grid->height - first_row; }
+
+		if (saving) {
+			for (size_t r = 0; r < band_rows; ++r) {
+				maze_grid_get_row(grid, first_row + r, band + r * grid->words_per_row,
+					band + band_words + r * grid->words_per_row);
+			}
+		}
+
+		for (uint64_t tile_col = 0; tile_col < header->tiles_across; ++tile_col) {
+			for (int plane = 0; plane < 2; ++plane) {
+				uint64_t* bits = band + plane * band_words;
+
+				for (uint32_t r = 0; r < header->tile_rows; ++r) {
+					for (uint32_t w = 0; w < header->tile_words; ++w, ++tile_word) {
+						size_t word = tile_col * header->tile_words + w;
+						bool inside = r < band_rows && word < grid->words_per_row;
+						uint64_t* band_word = bits + r * grid->words_per_row + word;
+
+						if (saving) { *tile_word = inside ? *band_word : ~(uint64_t)0; }
+						else if (inside) { *band_word = *tile_word; }
+					}
+				}
+			}
+		}
+
+		if (!saving) {
+			for (size_t r = 0; r < band_rows; ++r) {
+				maze_grid_set_row(grid, first_row + r, band + r * grid->words_per_row,
+					band + band_words + r * grid->words_per_row);
+			}
+		}
+	}
+
+	free(band);
+	return true;
+}
+
+// write a grid to a new binary maze file through a shared writable mapping, returns false on any error
+bool maze_file_save(const char* path, const maze_grid* grid, unsigned long long seed, int algorithm) {
+	maze_file_header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, MAZE_FILE_MAGIC, sizeof(MAZE_FILE_MAGIC));
+	header.version = MAZE_FILE_VERSION;
+	header.byte_order = MAZE_FILE_BYTE_ORDER;
+	header.width = grid->width;
+	header.height = grid->height;
+	header.entrance_col = grid->entrance_col;
+	header.algorithm = algorithm;
+	header.seed = seed;
+	header.tile_rows = MAZE_FILE_TILE_ROWS;
+	header.tile_words = MAZE_FILE_TILE_WORDS;
+	header.tiles_across = (grid->words_per_row + header.tile_words - 1) / header.tile_words;
+	header.tiles_down = ((uint64_t)grid->height + header.tile_rows - 1) / header.tile_rows;
+
+	// the tiles start on their own page so every tile maps cleanly
+	uint64_t page_size = sysconf(_SC_PAGESIZE);
+	header.data_offset = (sizeof(maze_file_header) + page_size - 1) / page_size * page_size;
+	header.file_size = header.data_offset + header.tiles_across * header.tiles_down
+		* 2 * header.tile_rows * header.tile_words * sizeof(uint64_t);
+
+	int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) { return false; }
+	if (ftruncate(fd, header.file_size) != 0) {
+		close(fd);
+		return false;
+	}
+
+	void* map = mmap(NULL, header.file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (map == MAP_FAILED) {
+		close(fd);
+		return false;
+	}
+	madvise(map, header.file_size, MADV_SEQUENTIAL);
+
+	memcpy(map, &header, sizeof(header));
+	bool ok = copy_tiles(&header, (uint64_t*)((char*)map + header.data_offset), (maze_grid*)grid, true);
+
+	// flush so write errors are reported here instead of getting lost
+	ok = ok && msync(map, header.file_size, MS_SYNC) == 0;
+	munmap(map, header.file_size);
+	return close(fd) == 0 && ok;
+}
+
+// map a binary maze file, only the header is touched. returns false when it isn't a valid maze file
+bool maze_file_open(maze_file* file, const char* path) {
+	file->map = NULL;
+	file->fd = open(path, O_RDONLY);
+	if (file->fd < 0) { return false; }
+
+	struct stat info;
+	if (fstat(file->fd, &info) != 0 || (size_t)info.st_size < sizeof(maze_file_header)) {
+		maze_file_close(file);
+		return false;
+	}
+
+	file->map_size = info.st_size;
+	file->map = mmap(NULL, file->map_size, PROT_READ, MAP_SHARED, file->fd, 0);
+	if (file->map == MAP_FAILED) {
+		file->map = NULL;
+		maze_file_close(file);
+		return false;
+	}
+
+	// check that the header describes exactly this file before anything trusts it: the tiles must cover
+	// exactly the grid of its dimensions, and every size is worked out without wrapping around
+	const maze_file_header* header = file->map;
+	bool valid = memcmp(header->magic, MAZE_FILE_MAGIC, sizeof(MAZE_FILE_MAGIC)) == 0
+		&& header->version == MAZE_FILE_VERSION
+		&& header->byte_order == MAZE_FILE_BYTE_ORDER
+		&& header->width > 0 && header->height > 0
+		&& header->entrance_col >= 0 && header->entrance_col < header->width
+		&& header->tile_rows > 0 && header->tile_words > 0
+		&& header->file_size == file->map_size
+		&& header->data_offset >= sizeof(maze_file_header);
+	if (valid) {
+		uint64_t words_per_row = ((uint64_t)header->width + 63) / 64;
+		uint64_t tile_bytes, num_tiles, data_bytes, end;
+		valid = header->tiles_across == (words_per_row + header->tile_words - 1) / header->tile_words
+			&& header->tiles_down == ((uint64_t)header->height + header->tile_rows - 1) / header->tile_rows
+			&& !__builtin_mul_overflow(2 * (uint64_t)header->tile_rows, (uint64_t)header->tile_words * sizeof(uint64_t), &tile_bytes)
+			&& !__builtin_mul_overflow(header->tiles_across, header->tiles_down, &num_tiles)
+			&& !__builtin_mul_overflow(num_tiles, tile_bytes, &data_bytes)
+			&& !__builtin_add_overflow(header->data_offset, data_bytes, &end)
+			&& end == header->file_size;
+	}
+	if (!valid) {
+		maze_file_close(file);
+		return false;
+	}
+
+	// readers usually jump to a region, so don't read ahead past the pages actually touched
+	madvise(file->map, file->map_size, MADV_RANDOM);
+
+	file->header = header;
+	file->tiles = (const uint64_t*)((const char*)file->map + header->data_offset);
+	return true;
+}
+
+// unmap and close a maze file
+void maze_file_close(maze_file* file) {
+	if (file->map != NULL) {
+		munmap(file->map, file->map_size);
+		file->map = NULL;
+	}
+	if (file->fd >= 0) {
+		close(file->fd);
+		file->fd = -1;
+	}
+}
+
+// copy the whole maze into a grid with the given MAZE_LAYOUT_*, the grid is allocated here out of
+// arena, or off the heap when arena is NULL. returns false when out of memory
+bool maze_file_load(const maze_file* file, maze_grid* grid, int layout, maze_arena* arena) {
+	if (!maze_grid_init_arena(grid, file->header->width, file->header->height, layout, arena)) { return false; }
+
+	madvise(file->map, file->map_size, MADV_SEQUENTIAL);
+	bool ok = copy_tiles(file->header, (uint64_t*)file->tiles, grid, false);
+	madvise(file->map, file->map_size, MADV_RANDOM);
+	if (!ok) {
+		maze_grid_free(grid);
+		return false;
+	}
+
+	grid->entrance_col = file->header->entrance_col;
+	return true;
+}
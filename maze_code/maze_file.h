@@ -0,0 +1,109 @@
+#ifndef _MAZE_FILE_H_
+#define _MAZE_FILE_H_
+
+#include "maze_grid.h"
+
+// +----------------------------------------------------------------------+
+// |                                                                      |
+// |                              FILES                                   |
+// |                                                                      |
+// +----------------------------------------------------------------------+
+
+// binary maze files are a page sized header followed by the wall bits cut into tiles. every tile
+// holds the south wall bitset of its rows followed by the east wall bitset, so any rectangle of the
+// maze only pages in the tiles it covers. files are opened with mmap and never read up front
+
+#define MAZE_FILE_MAGIC "MAZEBIN"
+#define MAZE_FILE_VERSION 1
+#define MAZE_FILE_BYTE_ORDER 0x01020304
+
+// default tile shape, 64 rows of 64 cells is 1 KB of walls per tile
+#define MAZE_FILE_TILE_ROWS 64
+#define MAZE_FILE_TILE_WORDS 1
+
+// +---------------------+
+// |   TYPE DEFINITION   |
+// +---------------------+
+
+typedef struct {
+	char magic[8];
+	uint32_t version;
+	// written as MAZE_FILE_BYTE_ORDER in the byte order of the machine that saved the file
+	uint32_t byte_order;
+
+	int32_t width;
+	int32_t height;
+	int32_t entrance_col;
+	int32_t algorithm;
+	uint64_t seed;
+
+	// rows per tile and 64 cell words per tile row
+	uint32_t tile_rows;
+	uint32_t tile_words;
+	uint64_t tiles_across;
+	uint64_t tiles_down;
+
+	// offset of the first tile from the start of the file, page aligned
+	uint64_t data_offset;
+	uint64_t file_size;
+} maze_file_header;
+
+// an open maze file mapped into memory
+typedef struct {
+	int fd;
+	void* map;
+	size_t map_size;
+
+	const maze_file_header* header;
+	const uint64_t* tiles;
+} maze_file;
+
+// +---------------+
+// |   FUNCTIONS   |
+// +---------------+
+
+// write a grid to a new binary maze file through a shared writable mapping, returns false on any error
+bool maze_file_save(const char* path, const maze_grid* grid, unsigned long long seed, int algorithm);
+
+// map a binary maze file, only the header is touched. returns false when it isn't a valid maze file
+bool maze_file_open(maze_file* file, const char* path);
+// unmap and close a maze file
+void maze_file_close(maze_file* file);
+
+// copy the whole maze into a grid with the given MAZE_LAYOUT_*, the grid is allocated here out of
+// arena, or off the heap when arena is NULL. returns false when out of memory
+bool maze_file_load(const maze_file* file, maze_grid* grid, int layout, maze_arena* arena);
+
+// +--------------------+
+// |   CELL ACCESSORS   |
+// +--------------------+
+
+// word of a tile bitset that holds the given cell, plane 0 is the south walls and plane 1 the east walls
+static inline const uint64_t* maze_file_word(const maze_file* file, int plane, int row, int col) {
+	const maze_file_header* header = file->header;
+	size_t word_col = col / 64;
+	size_t tile = (size_t)(row / header->tile_rows) * header->tiles_across + word_col / header->tile_words;
+	size_t tile_plane_words = (size_t)header->tile_rows * header->tile_words;
+
+	return file->tiles + tile * 2 * tile_plane_words + plane * tile_plane_words
+		+ (row % header->tile_rows) * header->tile_words + word_col % header->tile_words;
+}
+
+// whether the given side of a cell has a wall, read straight from the mapping the same way as maze_has_wall
+static inline bool maze_file_has_wall(const maze_file* file, int row, int col, int direction) {
+	switch (direction) {
+		case north:
+			if (row == 0) { return col != file->header->entrance_col; }
+			return maze_test_bit(maze_file_word(file, 0, row - 1, col), col & 63);
+		case south:
+			return maze_test_bit(maze_file_word(file, 0, row, col), col & 63);
+		case east:
+			return maze_test_bit(maze_file_word(file, 1, row, col), col & 63);
+		case west:
+			if (col == 0) { return true; }
+			return maze_test_bit(maze_file_word(file, 1, row, col - 1), (col - 1) & 63);
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,398 @@
+#include <stdlib.h>
+#include <string.h>
+#include "maze_fill.h"
+#include "maze_thread.h"
+
+// +---------------+
+// |   FUNCTIONS   |
+// +---------------+
+
+// set up a filling that owns no memory yet
+void maze_fill_init(maze_fill* fill) {
+	fill->words = 0;
+	fill->dead = NULL;
+	fill->south_walls = NULL;
+	fill->east_walls = NULL;
+	fill->solid = NULL;
+	fill->solid_words = 0;
+	fill->stack = NULL;
+	fill->stack_capacity = 0;
+	fill->dead_cells = 0;
+	fill->sweeps = 0;
+	fill->branched = false;
+	fill->arena = NULL;
+}
+
+// release the memory held by a filling
+void maze_fill_free(maze_fill* fill) {
+	maze_release(fill->arena, fill->dead);
+	maze_release(fill->arena, fill->south_walls);
+	maze_release(fill->arena, fill->east_walls);
+	maze_release(fill->arena, fill->solid);
+	maze_release(fill->arena, fill->stack);
+	maze_arena* arena = fill->arena;
+	maze_fill_init(fill);
+	fill->arena = arena;
+}
+
+// grow the buffers to fit the grid, returns false when out of memory
+static bool reserve(maze_fill* fill, const maze_grid* grid) {
+	size_t words = (size_t)grid->height * grid->words_per_row;
+	if (fill->words < words) {
+		maze_fill_free(fill);
+		fill->dead = maze_alloc(fill->arena, words * sizeof(uint64_t));
+		if (fill->dead == NULL) { return false; }
+		fill->words = words;
+	}
+
+	if (fill->solid_words < grid->words_per_row) {
+		maze_release(fill->arena, fill->solid);
+		fill->solid = maze_alloc(fill->arena, grid->words_per_row * sizeof(uint64_t));
+		fill->solid_words = (fill->solid == NULL) ? 0 : grid->words_per_row;
+		if (fill->solid == NULL) { return false; }
+		memset(fill->solid, 0xff, grid->words_per_row * sizeof(uint64_t));
+	}
+
+	if (grid->layout != MAZE_LAYOUT_ROW_MAJOR && fill->south_walls == NULL) {
+		fill->south_walls = maze_alloc(fill->arena, fill->words * sizeof(uint64_t));
+		fill->east_walls = maze_alloc(fill->arena, fill->words * sizeof(uint64_t));
+		if (fill->south_walls == NULL || fill->east_walls == NULL) {
+			maze_fill_free(fill);
+			return false;
+		}
+	}
+	return true;
+}
+
+// live cells of one word with at most one open side that leads to a live cell. the neighboring
+// words give the cells across the word edges, and the rows above and below the vertical sides
+static inline uint64_t dead_end_word(uint64_t dead, uint64_t dead_prev, uint64_t dead_next,
+		uint64_t east_wall, uint64_t east_prev, uint64_t south_wall, uint64_t south_above,
+		uint64_t dead_below, uint64_t dead_above) {
+	uint64_t alive = ~dead;
+	uint64_t open_east = ~east_wall & ((alive >> 1) | (~dead_next << 63));
+	uint64_t open_west = ~((east_wall << 1) | (east_prev >> 63)) & ((alive << 1) | (~dead_prev >> 63));
+	uint64_t open_south = ~south_wall & ~dead_below;
+	uint64_t open_north = ~south_above & ~dead_above;
+
+	// at least two of the four sides are open when both of a pair are, or one of each pair is
+	uint64_t two_open = (open_east & open_west) | (open_south & open_north)
+		| ((open_east ^ open_west) & (open_south ^ open_north));
+	return alive & ~two_open;
+}
+
+// the rows around one row of a filling, rows past the edge of the grid are solid
+typedef struct {
+	const uint64_t* dead_above;
+	const uint64_t* dead;
+	const uint64_t* dead_below;
+	const uint64_t* south_above;
+	const uint64_t* south_walls;
+	const uint64_t* east_walls;
+} fill_rows;
+
+// find the dead ends of a whole row at once. every word only reads the words around it, so the
+// loop over the middle of the row has no dependencies between words and vectorizes
+static void find_dead_ends(const fill_rows* rows, uint64_t* restrict found, size_t words, uint64_t border) {
+	const uint64_t* restrict dead_above = rows->dead_above;
+	const uint64_t* restrict dead = rows->dead;
+	const uint64_t* restrict dead_below = rows->dead_below;
+	const uint64_t* restrict south_above = rows->south_above;
+	const uint64_t* restrict south_walls = rows->south_walls;
+	const uint64_t* restrict east_walls = rows->east_walls;
+	uint64_t edge = ~(uint64_t)0;
+	size_t last = words - 1;
+
+	if (words == 1) {
+		found[0] = dead_end_word(dead[0], edge, edge, east_walls[0] | border, edge, south_walls[0], south_above[0],
+			dead_below[0], dead_above[0]);
+		return;
+	}
+
+	found[0] = dead_end_word(dead[0], edge, dead[1], east_walls[0], edge, south_walls[0], south_above[0],
+		dead_below[0], dead_above[0]);
+	for (size_t i = 1; i < last; ++i) {
+		found[i] = dead_end_word(dead[i], dead[i - 1], dead[i + 1], east_walls[i], east_walls[i - 1], south_walls[i], south_above[i],
+			dead_below[i], dead_above[i]);
+	}
+	found[last] = dead_end_word(dead[last], dead[last - 1], edge, east_walls[last] | border, east_walls[last - 1],
+		south_walls[last], south_above[last], dead_below[last], dead_above[last]);
+}
+
+// shared state of the threaded sweeps
+typedef struct {
+	maze_fill* fill;
+	const maze_grid* grid;
+	const uint64_t* south_walls;
+	const uint64_t* east_walls;
+	uint64_t border;
+
+	int num_bands;
+	// which half of the bands is being swept, and whether rows go top to bottom
+	int phase;
+	bool downward;
+
+	// one row of found dead ends and the cells filled in the last sweep for every band
+	uint64_t* found;
+	long long* filled;
+} fill_job;
+
+// point at the rows around a row
+static void rows_around(const fill_job* job, int row, fill_rows* rows) {
+	const maze_grid* grid = job->grid;
+	size_t words_per_row = grid->words_per_row;
+	const uint64_t* solid = job->fill->solid;
+	size_t offset = (size_t)row * words_per_row;
+
+	rows->dead = job->fill->dead + offset;
+	rows->east_walls = job->east_walls + offset;
+	rows->dead_above = (row > 0) ? rows->dead - words_per_row : solid;
+	rows->south_above = (row > 0) ? job->south_walls + offset - words_per_row : solid;
+	// the south side of the last row is closed even where the exit is, the exit is never filled anyway
+	rows->dead_below = (row + 1 < grid->height) ? rows->dead + words_per_row : solid;
+	rows->south_walls = (row + 1 < grid->height) ? job->south_walls + offset : solid;
+}
+
+// the entrance and the exit are never filled
+static inline void keep_endpoints(const maze_grid* grid, int row, uint64_t* found) {
+	if (row == 0) { found[0] &= ~(uint64_t)1; }
+	if (row == grid->height - 1) { found[(grid->width - 1) / 64] &= ~((uint64_t)1 << ((grid->width - 1) & 63)); }
+}
+
+// sweep one band, filling each row with the rows before it already up to date
+static void sweep_band(int index, void* task_data) {
+	fill_job* job = task_data;
+	const maze_grid* grid = job->grid;
+	int band = 2 * index + job->phase;
+	if (band >= job->num_bands) { return; }
+
+	size_t words_per_row = grid->words_per_row;
+	uint64_t* found = job->found + (size_t)band * words_per_row;
+	int top = band * MAZE_FILL_BAND_ROWS;
+	int rows = (top + MAZE_FILL_BAND_ROWS > grid->height) ? grid->height - top : MAZE_FILL_BAND_ROWS;
+
+	long long filled = 0;
+	for (int i = 0; i < rows; ++i) {
+		int row = job->downward ? top + i : top + rows - 1 - i;
+		fill_rows around;
+		rows_around(job, row, &around);
+		find_dead_ends(&around, found, words_per_row, job->border);
+		keep_endpoints(grid, row, found);
+
+		uint64_t* dead = job->fill->dead + (size_t)row * words_per_row;
+		for (size_t w = 0; w < words_per_row; ++w) {
+			dead[w] |= found[w];
+			filled += __builtin_popcountll(found[w]);
+		}
+	}
+	job->filled[band] = filled;
+}
+
+// whether a side of a live cell is open and leads to a live cell
+static inline bool open_to_live(const fill_job* job, int row, int col, int direction) {
+	const maze_grid* grid = job->grid;
+	size_t bit = (size_t)row * grid->words_per_row * 64 + col;
+	switch (direction) {
+		case north:
+			return row > 0 && !maze_test_bit(job->south_walls, bit - grid->words_per_row * 64)
+				&& !maze_test_bit(job->fill->dead, bit - grid->words_per_row * 64);
+		case south:
+			return row + 1 < grid->height && !maze_test_bit(job->south_walls, bit)
+				&& !maze_test_bit(job->fill->dead, bit + grid->words_per_row * 64);
+		case east:
+			return col + 1 < grid->width && !maze_test_bit(job->east_walls, bit)
+				&& !maze_test_bit(job->fill->dead, bit + 1);
+		case west:
+			return col > 0 && !maze_test_bit(job->east_walls, bit - 1)
+				&& !maze_test_bit(job->fill->dead, bit - 1);
+	}
+	return false;
+}
+
+// push a cell onto the stack of cells to check, returns false when out of memory
+static bool push_cell(maze_fill* fill, size_t* size, uint32_t cell) {
+	if (*size == fill->stack_capacity) {
+		size_t capacity = (fill->stack_capacity == 0) ? 1024 : 2 * fill->stack_capacity;
+		uint32_t* stack = maze_realloc(fill->arena, fill->stack, fill->stack_capacity * sizeof(uint32_t),
+			capacity * sizeof(uint32_t));
+		if (stack == NULL) { return false; }
+		fill->stack = stack;
+		fill->stack_capacity = capacity;
+	}
+	fill->stack[(*size)++] = cell;
+	return true;
+}
+
+// follow the remaining dead ends one cell at a time, each filled cell can only turn the one live
+// cell it was still open to into a new dead end
+static bool fill_remaining(fill_job* job) {
+	maze_fill* fill = job->fill;
+	const maze_grid* grid = job->grid;
+	size_t words_per_row = grid->words_per_row;
+	size_t size = 0;
+
+	for (int row = 0; row < grid->height; ++row) {
+		fill_rows around;
+		rows_around(job, row, &around);
+		find_dead_ends(&around, job->found, words_per_row, job->border);
+		keep_endpoints(grid, row, job->found);
+		for (size_t w = 0; w < words_per_row; ++w) {
+			for (uint64_t cells = job->found[w]; cells != 0; cells &= cells - 1) {
+				uint32_t cell = (uint32_t)row * grid->width + w * 64 + __builtin_ctzll(cells);
+				if (!push_cell(fill, &size, cell)) { return false; }
+			}
+		}
+	}
+
+	while (size > 0) {
+		uint32_t cell = fill->stack[--size];
+		int row = cell / grid->width;
+		int col = cell % grid->width;
+		size_t bit = (size_t)row * words_per_row * 64 + col;
+		if (maze_test_bit(fill->dead, bit)) { continue; }
+		if ((row == 0 && col == 0) || (row == grid->height - 1 && col == grid->width - 1)) { continue; }
+
+		int open = 0;
+		int last_open = 0;
+		for (int direction = north; direction <= west; ++direction) {
+			if (open_to_live(job, row, col, direction)) {
+				++open;
+				last_open = direction;
+			}
+		}
+		if (open > 1) { continue; }
+
+		maze_set_bit(fill->dead, bit);
+		if (open == 1) {
+			int next_row = row + (last_open == south) - (last_open == north);
+			int next_col = col + (last_open == east) - (last_open == west);
+			if (!push_cell(fill, &size, (uint32_t)next_row * grid->width + next_col)) { return false; }
+		}
+	}
+	return true;
+}
+
+// clear the filled cells of one band, marking the padding past the last column as filled
+static void clear_band(int band, void* task_data) {
+	fill_job* job = task_data;
+	const maze_grid* grid = job->grid;
+	size_t words_per_row = grid->words_per_row;
+	int top = band * MAZE_FILL_BAND_ROWS;
+	int rows = (top + MAZE_FILL_BAND_ROWS > grid->height) ? grid->height - top : MAZE_FILL_BAND_ROWS;
+
+	uint64_t* dead = job->fill->dead + (size_t)top * words_per_row;
+	memset(dead, 0, (size_t)rows * words_per_row * sizeof(uint64_t));
+	if (grid->width & 63) {
+		for (int i = 0; i < rows; ++i) {
+			dead[i * words_per_row + words_per_row - 1] = ~(uint64_t)0 << (grid->width & 63);
+		}
+	}
+}
+
+// fill every dead end of the maze on num_threads threads
+bool maze_fill_dead_ends(maze_fill* fill, const maze_grid* grid, int num_threads) {
+	if ((size_t)grid->width * grid->height > (size_t)UINT32_MAX) { return false; }
+	if (!reserve(fill, grid)) { return false; }
+
+	fill_job job;
+	job.fill = fill;
+	job.grid = grid;
+	job.south_walls = grid->south_walls;
+	job.east_walls = grid->east_walls;
+	job.border = ~(uint64_t)0 << ((grid->width - 1) & 63);
+	job.num_bands = (grid->height + MAZE_FILL_BAND_ROWS - 1) / MAZE_FILL_BAND_ROWS;
+	if (num_threads < 1) { num_threads = 1; }
+
+	if (grid->layout != MAZE_LAYOUT_ROW_MAJOR) {
+		size_t words_per_row = grid->words_per_row;
+		for (int row = 0; row < grid->height; ++row) {
+			maze_grid_get_row(grid, row, fill->south_walls + row * words_per_row, fill->east_walls + row * words_per_row);
+		}
+		job.south_walls = fill->south_walls;
+		job.east_walls = fill->east_walls;
+	}
+
+	job.found = malloc((size_t)job.num_bands * grid->words_per_row * sizeof(uint64_t));
+	job.filled = malloc(job.num_bands * sizeof(long long));
+	if (job.found == NULL || job.filled == NULL) {
+		free(job.found);
+		free(job.filled);
+		return false;
+	}
+	maze_parallel_for(job.num_bands, num_threads, clear_band, &job);
+
+	// sweep the even bands and then the odd bands, so no two threads ever sweep neighboring rows,
+	// and turn around every sweep so dead ends running up and down both collapse quickly
+	int half = (job.num_bands + 1) / 2;
+	job.downward = true;
+	fill->sweeps = 0;
+	while (true) {
+		long long filled = 0;
+		for (job.phase = 0; job.phase < 2; ++job.phase) {
+			maze_parallel_for(half, num_threads, sweep_band, &job);
+			for (int band = job.phase; band < job.num_bands; band += 2) { filled += job.filled[band]; }
+		}
+		++fill->sweeps;
+		job.downward = !job.downward;
+
+		// following cells one at a time costs about as much per cell as a sweep costs per eight
+		// words, so hand over once a sweep fills fewer cells than that
+		if ((size_t)filled * 8 < fill->words) { break; }
+	}
+
+	bool ok = fill_remaining(&job);
+	free(job.found);
+	free(job.filled);
+	if (!ok) { return false; }
+
+	fill->dead_cells = 0;
+	for (size_t i = 0; i < (size_t)grid->height * grid->words_per_row; ++i) {
+		fill->dead_cells += __builtin_popcountll(fill->dead[i]);
+	}
+	fill->dead_cells -= (long long)grid->height * (grid->words_per_row * 64 - grid->width);
+	return true;
+}
+
+// fill the dead ends and walk the corridor that is left from the entrance to the exit
+bool maze_fill_solve(maze_fill* fill, const maze_grid* grid, int num_threads, maze_path* path) {
+	if (!maze_fill_dead_ends(fill, grid, num_threads)) { return false; }
+
+	fill_job job;
+	job.fill = fill;
+	job.grid = grid;
+	job.south_walls = (grid->layout == MAZE_LAYOUT_ROW_MAJOR) ? grid->south_walls : fill->south_walls;
+	job.east_walls = (grid->layout == MAZE_LAYOUT_ROW_MAJOR) ? grid->east_walls : fill->east_walls;
+
+	// the start cell is marked as entered heading south like the entrance in solve_maze
+	fill->branched = false;
+	int row = 0;
+	int col = 0;
+	int orientation = south;
+	long long live_cells = (long long)grid->width * grid->height - fill->dead_cells;
+	path->length = 0;
+	while (true) {
+		if (path->length == live_cells || !maze_path_reserve(path, path->length + 1)) { return false; }
+		maze_step* step = &path->steps[path->length++];
+		step->row = row;
+		step->col = col;
+		step->orientation = orientation;
+		if (row == grid->height - 1 && col == grid->width - 1) { return true; }
+
+		// carry on down the corridor through the one side other than the one just come in from.
+		// a loop leaves more than one, and walking on could go around it forever
+		int back = (orientation + 1) % 4 + 1;
+		int next = 0;
+		for (int direction = north; direction <= west; ++direction) {
+			if (direction == back || !open_to_live(&job, row, col, direction)) { continue; }
+			if (next != 0) {
+				fill->branched = true;
+				return false;
+			}
+			next = direction;
+		}
+		if (next == 0) { return false; }
+		orientation = next;
+		row += (next == south) - (next == north);
+		col += (next == east) - (next == west);
+	}
+}
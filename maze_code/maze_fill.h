@@ -0,0 +1,76 @@
+#ifndef _MAZE_FILL_H_
+#define _MAZE_FILL_H_
+
+#include "maze_grid.h"
+#include "maze_solve.h"
+
+// +----------------------------------------------------------------------+
+// |                                                                      |
+// |                          DEAD END FILLING                            |
+// |                                                                      |
+// +----------------------------------------------------------------------+
+
+// dead end filling walls off every cell other than the entrance and the exit that has at most one
+// open side left, over and over until nothing but the solution corridor (and any loops) is left.
+// the filling is done in sweeps over whole rows of the wall bitsets that compute 64 cells per word
+// with plain bit logic the compiler can vectorize, split across threads by row bands. once a sweep
+// fills too few cells to be worth a whole pass, the last long dead ends are followed one cell at a time
+
+// rows in each band of a threaded sweep
+#define MAZE_FILL_BAND_ROWS 64
+
+// +---------------------+
+// |   TYPE DEFINITION   |
+// +---------------------+
+
+// buffers of the filling, kept between fills so only the first fill of the biggest grid allocates
+typedef struct {
+	size_t words;
+
+	// row major bitset of the filled cells, the padding past the last column counts as filled
+	uint64_t* dead;
+
+	// row major copy of the walls, only filled in for grids in another layout
+	uint64_t* south_walls;
+	uint64_t* east_walls;
+
+	// row of walls standing in for the rows above the first and below the last
+	uint64_t* solid;
+	size_t solid_words;
+
+	// cells still to be checked once the sweeps stop paying off
+	uint32_t* stack;
+	size_t stack_capacity;
+
+	long long dead_cells;
+	long long sweeps;
+	// set by maze_fill_solve when the corridor that is left branches, which only happens when the
+	// maze has loops, the unfilled cells then have to be searched instead of walked
+	bool branched;
+
+	// arena the buffers come from, NULL when they are on the heap
+	maze_arena* arena;
+} maze_fill;
+
+// +---------------+
+// |   FUNCTIONS   |
+// +---------------+
+
+// set up a filling that owns no memory yet
+void maze_fill_init(maze_fill* fill);
+// release the memory held by a filling
+void maze_fill_free(maze_fill* fill);
+
+// fill every dead end of the maze on num_threads threads, returns false when out of memory
+bool maze_fill_dead_ends(maze_fill* fill, const maze_grid* grid, int num_threads);
+
+// fill the dead ends and walk the corridor that is left from the entrance to the exit, returns false
+// when out of memory or when the corridor doesn't lead to the exit, with branched set when it forks
+bool maze_fill_solve(maze_fill* fill, const maze_grid* grid, int num_threads, maze_path* path);
+
+// whether a cell was filled as part of a dead region by the last filling
+static inline bool maze_fill_is_dead(const maze_fill* fill, const maze_grid* grid, int row, int col) {
+	return maze_test_bit(fill->dead, (size_t)row * grid->words_per_row * 64 + col);
+}
+
+#endif
@@ -0,0 +1,544 @@
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "maze_flood.h"
+#include "maze_thread.h"
+
+// +---------------+
+// |   FUNCTIONS   |
+// +---------------+
+
+// set up a flood that owns no memory yet
+void maze_flood_init(maze_flood* flood) {
+	flood->words = 0;
+	flood->cells = 0;
+	flood->frontier = NULL;
+	flood->next = NULL;
+	flood->reached = NULL;
+	flood->south_walls = NULL;
+	flood->east_walls = NULL;
+	flood->active = NULL;
+	flood->next_active = NULL;
+	flood->distances = NULL;
+	flood->reached_cells = 0;
+	flood->levels = 0;
+	flood->arena = NULL;
+}
+
+// release the memory held by a flood
+void maze_flood_free(maze_flood* flood) {
+	maze_release(flood->arena, flood->frontier);
+	maze_release(flood->arena, flood->next);
+	maze_release(flood->arena, flood->reached);
+	maze_release(flood->arena, flood->south_walls);
+	maze_release(flood->arena, flood->east_walls);
+	maze_release(flood->arena, flood->active);
+	maze_release(flood->arena, flood->next_active);
+	maze_release(flood->arena, flood->distances);
+	maze_arena* arena = flood->arena;
+	maze_flood_init(flood);
+	flood->arena = arena;
+}
+
+// grow the buffers to fit the grid, returns false when out of memory
+static bool reserve(maze_flood* flood, const maze_grid* grid) {
+	size_t words = (size_t)grid->height * grid->words_per_row;
+	size_t cells = (size_t)grid->width * grid->height;
+
+	if (flood->words < words || flood->cells < cells) {
+		maze_flood_free(flood);
+		// frontier and next are left empty after every flood, so they are only cleared here
+		flood->frontier = maze_calloc(flood->arena, words, sizeof(uint64_t));
+		flood->next = maze_calloc(flood->arena, words, sizeof(uint64_t));
+		flood->reached = maze_alloc(flood->arena, words * sizeof(uint64_t));
+		flood->active = maze_alloc(flood->arena, words * sizeof(size_t));
+		flood->next_active = maze_alloc(flood->arena, words * sizeof(size_t));
+		flood->distances = maze_alloc(flood->arena, cells * sizeof(uint32_t));
+		if (flood->frontier == NULL || flood->next == NULL || flood->reached == NULL
+				|| flood->active == NULL || flood->next_active == NULL || flood->distances == NULL) {
+			maze_flood_free(flood);
+			return false;
+		}
+		flood->words = words;
+		flood->cells = cells;
+	}
+
+	if (grid->layout != MAZE_LAYOUT_ROW_MAJOR && flood->south_walls == NULL) {
+		flood->south_walls = maze_alloc(flood->arena, flood->words * sizeof(uint64_t));
+		flood->east_walls = maze_alloc(flood->arena, flood->words * sizeof(uint64_t));
+		if (flood->south_walls == NULL || flood->east_walls == NULL) {
+			maze_flood_free(flood);
+			return false;
+		}
+	}
+	return true;
+}
+
+// east walls of a word with the east border and the padding past it always closed
+static inline uint64_t east_walls_of(const uint64_t* east_walls, size_t word, size_t word_col,
+		size_t words_per_row, uint64_t border) {
+	return (word_col + 1 == words_per_row) ? east_walls[word] | border : east_walls[word];
+}
+
+// add moves into a word of the next frontier, noting the word the first time it gets any
+static inline void push(maze_flood* flood, size_t* num_next, size_t word, uint64_t moves) {
+	if (moves == 0) { return; }
+	if (flood->next[word] == 0) { flood->next_active[(*num_next)++] = word; }
+	flood->next[word] |= moves;
+}
+
+// flood the whole maze from one cell and fill in the distance of every cell
+bool maze_flood_from(maze_flood* flood, const maze_grid* grid, int row, int col) {
+	if (row < 0 || row >= grid->height || col < 0 || col >= grid->width) { return false; }
+	if (!reserve(flood, grid)) { return false; }
+
+	size_t words_per_row = grid->words_per_row;
+	size_t words = (size_t)grid->height * words_per_row;
+	const uint64_t* south_walls = grid->south_walls;
+	const uint64_t* east_walls = grid->east_walls;
+	if (grid->layout != MAZE_LAYOUT_ROW_MAJOR) {
+		for (int r = 0; r < grid->height; ++r) {
+			maze_grid_get_row(grid, r, flood->south_walls + r * words_per_row, flood->east_walls + r * words_per_row);
+		}
+		south_walls = flood->south_walls;
+		east_walls = flood->east_walls;
+	}
+
+	uint64_t border = ~(uint64_t)0 << ((grid->width - 1) & 63);
+	memset(flood->reached, 0, words * sizeof(uint64_t));
+	memset(flood->distances, 0xff, (size_t)grid->width * grid->height * sizeof(uint32_t));
+
+	size_t start = (size_t)row * words_per_row + col / 64;
+	flood->frontier[start] = (uint64_t)1 << (col & 63);
+	flood->reached[start] = flood->frontier[start];
+	flood->distances[(size_t)row * grid->width + col] = 0;
+	flood->active[0] = start;
+	size_t num_active = 1;
+	flood->reached_cells = 1;
+
+	uint32_t level = 0;
+	while (num_active > 0) {
+		++level;
+
+		// move every frontier word one step in each direction its walls allow
+		size_t num_next = 0;
+		for (size_t i = 0; i < num_active; ++i) {
+			size_t word = flood->active[i];
+			uint64_t cells = flood->frontier[word];
+			flood->frontier[word] = 0;
+
+			size_t word_row = word / words_per_row;
+			size_t word_col = word - word_row * words_per_row;
+			uint64_t walls = east_walls_of(east_walls, word, word_col, words_per_row, border);
+
+			// east through open east walls, the top cell carries into the next word
+			uint64_t moves = cells & ~walls;
+			push(flood, &num_next, word, moves << 1);
+			if ((moves >> 63) && word_col + 1 < words_per_row) { push(flood, &num_next, word + 1, 1); }
+
+			// west through the open east walls of the cells to the left
+			push(flood, &num_next, word, (cells >> 1) & ~walls);
+			if ((cells & 1) && word_col > 0 && !(east_walls[word - 1] >> 63)) {
+				push(flood, &num_next, word - 1, (uint64_t)1 << 63);
+			}
+
+			// south through open south walls and north through the open south walls of the row above
+			if (word_row + 1 < (size_t)grid->height) {
+				push(flood, &num_next, word + words_per_row, cells & ~south_walls[word]);
+			}
+			if (word_row > 0) {
+				push(flood, &num_next, word - words_per_row, cells & ~south_walls[word - words_per_row]);
+			}
+		}
+
+		// keep only cells that weren't reached before, they become the next frontier
+		num_active = 0;
+		for (size_t i = 0; i < num_next; ++i) {
+			size_t word = flood->next_active[i];
+			uint64_t cells = flood->next[word] & ~flood->reached[word];
+			flood->next[word] = 0;
+			if (cells == 0) { continue; }
+
+			flood->reached[word] |= cells;
+			flood->frontier[word] = cells;
+			flood->active[num_active++] = word;
+			flood->reached_cells += __builtin_popcountll(cells);
+
+			size_t word_row = word / words_per_row;
+			uint32_t* distances = flood->distances + word_row * grid->width + (word - word_row * words_per_row) * 64;
+			for (; cells != 0; cells &= cells - 1) {
+				distances[__builtin_ctzll(cells)] = level;
+			}
+		}
+	}
+
+	flood->levels = level;
+	return true;
+}
+
+// fill every cell reachable inside one word from the cells in fill, east through the cells that
+// can be entered from the left and then west through the cells that can be entered from the right.
+// six doubling steps each way cover the whole word no matter how long the corridor is
+static inline uint64_t fill_row(uint64_t fill, uint64_t east_walls) {
+	uint64_t pass = ~east_walls << 1;
+	for (int shift = 1; shift < 64; shift *= 2) {
+		fill |= pass & (fill << shift);
+		pass &= pass << shift;
+	}
+	pass = ~east_walls;
+	for (int shift = 1; shift < 64; shift *= 2) {
+		fill |= pass & (fill >> shift);
+		pass &= pass >> shift;
+	}
+	return fill;
+}
+
+// seed cells of a word that weren't reached yet, queueing the word when it had no seeds
+static inline void seed(maze_flood* flood, size_t* num_active, size_t word, uint64_t cells) {
+	cells &= ~flood->reached[word];
+	if (cells == 0) { return; }
+	if (flood->frontier[word] == 0) { flood->active[(*num_active)++] = word; }
+	flood->frontier[word] |= cells;
+	flood->reached[word] |= cells;
+}
+
+// mark every cell reachable from one cell in the reached bitset, without distances
+bool maze_flood_reach(maze_flood* flood, const maze_grid* grid, int row, int col) {
+	if (row < 0 || row >= grid->height || col < 0 || col >= grid->width) { return false; }
+	if (!reserve(flood, grid)) { return false; }
+
+	size_t words_per_row = grid->words_per_row;
+	size_t words = (size_t)grid->height * words_per_row;
+	const uint64_t* south_walls = grid->south_walls;
+	const uint64_t* east_walls = grid->east_walls;
+	if (grid->layout != MAZE_LAYOUT_ROW_MAJOR) {
+		for (int r = 0; r < grid->height; ++r) {
+			maze_grid_get_row(grid, r, flood->south_walls + r * words_per_row, flood->east_walls + r * words_per_row);
+		}
+		south_walls = flood->south_walls;
+		east_walls = flood->east_walls;
+	}
+	uint64_t border = ~(uint64_t)0 << ((grid->width - 1) & 63);
+	memset(flood->reached, 0, words * sizeof(uint64_t));
+
+	// the active list is used as a stack of words with seeds, order doesn't matter without distances
+	size_t num_active = 0;
+	seed(flood, &num_active, (size_t)row * words_per_row + col / 64, (uint64_t)1 << (col & 63));
+
+	while (num_active > 0) {
+		size_t word = flood->active[--num_active];
+		uint64_t seeds = flood->frontier[word];
+		flood->frontier[word] = 0;
+
+		size_t word_row = word / words_per_row;
+		size_t word_col = word - word_row * words_per_row;
+		uint64_t walls = east_walls_of(east_walls, word, word_col, words_per_row, border);
+
+		// close the seeds over the corridors of their row, only the new cells spread further
+		uint64_t before = flood->reached[word] & ~seeds;
+		uint64_t cells = fill_row(seeds, walls) & ~before;
+		flood->reached[word] |= cells;
+
+		if ((cells >> 63) && !(walls >> 63) && word_col + 1 < words_per_row) {
+			seed(flood, &num_active, word + 1, 1);
+		}
+		if ((cells & 1) && word_col > 0 && !(east_walls[word - 1] >> 63)) {
+			seed(flood, &num_active, word - 1, (uint64_t)1 << 63);
+		}
+		if (word_row + 1 < (size_t)grid->height) {
+			seed(flood, &num_active, word + words_per_row, cells & ~south_walls[word]);
+		}
+		if (word_row > 0) {
+			seed(flood, &num_active, word - words_per_row, cells & ~south_walls[word - words_per_row]);
+		}
+	}
+
+	flood->reached_cells = 0;
+	for (size_t i = 0; i < words; ++i) {
+		flood->reached_cells += __builtin_popcountll(flood->reached[i]);
+	}
+	flood->levels = 0;
+	return true;
+}
+
+// one cell waiting to be given a distance by the owner of its band
+typedef struct {
+	int row;
+	int col;
+	uint32_t distance;
+} flood_item;
+
+// a band of MAZE_FLOOD_BAND_ROWS rows, only the thread holding lock writes its distances
+typedef struct {
+	pthread_mutex_t lock;
+
+	// cells sent here from other bands, guarded by inbox_lock
+	pthread_mutex_t inbox_lock;
+	flood_item* inbox;
+	size_t inbox_size;
+	size_t inbox_capacity;
+	atomic_long waiting;
+
+	// FIFO of cells found inside the band, only touched while holding lock
+	flood_item* queue;
+	size_t queue_capacity;
+
+	long long reached_cells;
+	uint32_t farthest;
+} flood_band;
+
+// shared state of the parallel flood workers
+typedef struct {
+	maze_flood* flood;
+	const maze_grid* grid;
+	const uint64_t* south_walls;
+	const uint64_t* east_walls;
+	uint64_t border;
+
+	flood_band* bands;
+	int num_bands;
+	int num_threads;
+
+	// cells sent to an inbox and not yet fully processed, the flood is done when this hits zero
+	atomic_llong pending;
+	atomic_int failed;
+} flood_job;
+
+// append an item to a growable array, returns false when out of memory
+static bool append_item(flood_item** items, size_t* size, size_t* capacity, flood_item item) {
+	if (*size == *capacity) {
+		size_t new_capacity = (*capacity == 0) ? 256 : 2 * *capacity;
+		flood_item* new_items = realloc(*items, new_capacity * sizeof(flood_item));
+		if (new_items == NULL) { return false; }
+		*items = new_items;
+		*capacity = new_capacity;
+	}
+	(*items)[(*size)++] = item;
+	return true;
+}
+
+// hand a cell to the band that owns it
+static void send_item(flood_job* job, flood_item item) {
+	flood_band* band = &job->bands[item.row / MAZE_FLOOD_BAND_ROWS];
+
+	// counted before it is visible so pending can't reach zero while the cell is in flight
+	atomic_fetch_add(&job->pending, 1);
+	pthread_mutex_lock(&band->inbox_lock);
+	if (append_item(&band->inbox, &band->inbox_size, &band->inbox_capacity, item)) {
+		atomic_fetch_add(&band->waiting, 1);
+	} else {
+		atomic_store(&job->failed, 1);
+		atomic_fetch_sub(&job->pending, 1);
+	}
+	pthread_mutex_unlock(&band->inbox_lock);
+}
+
+// give distances to every cell of a band that can be reached from its queue, cells across the
+// band edges are sent on to their own band. the caller holds the band lock
+static bool flood_band_cells(flood_job* job, flood_band* band, size_t* queue_size) {
+	const maze_grid* grid = job->grid;
+	uint32_t* distances = job->flood->distances;
+	size_t words_per_row = grid->words_per_row;
+	int band_top = (int)(band - job->bands) * MAZE_FLOOD_BAND_ROWS;
+	int band_bottom = band_top + MAZE_FLOOD_BAND_ROWS - 1;
+
+	for (size_t head = 0; head < *queue_size; ++head) {
+		flood_item item = band->queue[head];
+		size_t cell = (size_t)item.row * grid->width + item.col;
+		if (item.distance >= distances[cell]) { continue; }
+
+		if (distances[cell] == MAZE_FLOOD_UNREACHED) {
+			++band->reached_cells;
+			maze_set_bit(job->flood->reached, (size_t)item.row * words_per_row * 64 + item.col);
+		}
+		distances[cell] = item.distance;
+
+		size_t bit = (size_t)item.row * words_per_row * 64 + item.col;
+		size_t word_col = (size_t)item.col / 64;
+		uint64_t walls = east_walls_of(job->east_walls, bit / 64, word_col, words_per_row, job->border);
+		bool open[5];
+		open[north] = item.row > 0 && !maze_test_bit(job->south_walls, bit - words_per_row * 64);
+		open[east] = !((walls >> (item.col & 63)) & 1);
+		open[south] = item.row + 1 < grid->height && !maze_test_bit(job->south_walls, bit);
+		open[west] = item.col > 0 && !maze_test_bit(job->east_walls, bit - 1);
+
+		for (int direction = north; direction <= west; ++direction) {
+			if (!open[direction]) { continue; }
+			flood_item next;
+			next.row = item.row + (direction == south) - (direction == north);
+			next.col = item.col + (direction == east) - (direction == west);
+			next.distance = item.distance + 1;
+
+			if (next.row < band_top || next.row > band_bottom) {
+				send_item(job, next);
+			} else if (distances[(size_t)next.row * grid->width + next.col] > next.distance) {
+				if (!append_item(&band->queue, queue_size, &band->queue_capacity, next)) { return false; }
+			}
+		}
+	}
+	*queue_size = 0;
+	return true;
+}
+
+// worker that keeps taking any band with waiting cells until the whole flood is done
+static void flood_worker(int worker, void* task_data) {
+	flood_job* job = task_data;
+	int first = (int)((long long)worker * job->num_bands / job->num_threads);
+
+	while (atomic_load(&job->pending) > 0 && !atomic_load(&job->failed)) {
+		bool worked = false;
+		for (int i = 0; i < job->num_bands; ++i) {
+			flood_band* band = &job->bands[(first + i) % job->num_bands];
+			if (atomic_load(&band->waiting) == 0) { continue; }
+			if (pthread_mutex_trylock(&band->lock) != 0) { continue; }
+
+			// keep going until no more cells arrive, then give back the ones this worker took
+			long long taken = 0;
+			while (atomic_load(&band->waiting) > 0) {
+				pthread_mutex_lock(&band->inbox_lock);
+				flood_item* arrived = band->inbox;
+				size_t num_arrived = band->inbox_size;
+				size_t arrived_capacity = band->inbox_capacity;
+				band->inbox = band->queue;
+				band->inbox_capacity = band->queue_capacity;
+				band->inbox_size = 0;
+				atomic_fetch_sub(&band->waiting, num_arrived);
+				pthread_mutex_unlock(&band->inbox_lock);
+
+				band->queue = arrived;
+				band->queue_capacity = arrived_capacity;
+				taken += num_arrived;
+				if (!flood_band_cells(job, band, &num_arrived)) { atomic_store(&job->failed, 1); }
+			}
+			atomic_fetch_sub(&job->pending, taken);
+
+			pthread_mutex_unlock(&band->lock);
+			worked = true;
+		}
+		if (!worked) { sched_yield(); }
+	}
+}
+
+// clear the distances and reached bits of one band before a parallel flood
+static void clear_band(int index, void* task_data) {
+	flood_job* job = task_data;
+	const maze_grid* grid = job->grid;
+	int top = index * MAZE_FLOOD_BAND_ROWS;
+	int rows = (top + MAZE_FLOOD_BAND_ROWS > grid->height) ? grid->height - top : MAZE_FLOOD_BAND_ROWS;
+
+	memset(job->flood->distances + (size_t)top * grid->width, 0xff, (size_t)rows * grid->width * sizeof(uint32_t));
+	memset(job->flood->reached + (size_t)top * grid->words_per_row, 0, (size_t)rows * grid->words_per_row * sizeof(uint64_t));
+}
+
+// find the farthest distance in one band after a parallel flood
+static void measure_band(int index, void* task_data) {
+	flood_job* job = task_data;
+	const maze_grid* grid = job->grid;
+	int top = index * MAZE_FLOOD_BAND_ROWS;
+	int rows = (top + MAZE_FLOOD_BAND_ROWS > grid->height) ? grid->height - top : MAZE_FLOOD_BAND_ROWS;
+
+	const uint32_t* distances = job->flood->distances + (size_t)top * grid->width;
+	uint32_t farthest = 0;
+	for (size_t i = 0; i < (size_t)rows * grid->width; ++i) {
+		if (distances[i] != MAZE_FLOOD_UNREACHED && distances[i] > farthest) { farthest = distances[i]; }
+	}
+	job->bands[index].farthest = farthest;
+}
+
+// flood the whole maze from one cell on several threads and fill in the distance of every cell
+bool maze_flood_parallel(maze_flood* flood, const maze_grid* grid, int row, int col, int num_threads) {
+	if (row < 0 || row >= grid->height || col < 0 || col >= grid->width) { return false; }
+	if ((size_t)grid->width * grid->height > (size_t)UINT32_MAX) { return false; }
+	if (!reserve(flood, grid)) { return false; }
+
+	flood_job job;
+	job.flood = flood;
+	job.grid = grid;
+	job.south_walls = grid->south_walls;
+	job.east_walls = grid->east_walls;
+	job.border = ~(uint64_t)0 << ((grid->width - 1) & 63);
+	job.num_bands = (grid->height + MAZE_FLOOD_BAND_ROWS - 1) / MAZE_FLOOD_BAND_ROWS;
+	job.num_threads = (num_threads < 1) ? 1 : num_threads;
+	atomic_init(&job.pending, 0);
+	atomic_init(&job.failed, 0);
+
+	if (grid->layout != MAZE_LAYOUT_ROW_MAJOR) {
+		size_t words_per_row = grid->words_per_row;
+		for (int r = 0; r < grid->height; ++r) {
+			maze_grid_get_row(grid, r, flood->south_walls + r * words_per_row, flood->east_walls + r * words_per_row);
+		}
+		job.south_walls = flood->south_walls;
+		job.east_walls = flood->east_walls;
+	}
+
+	job.bands = calloc(job.num_bands, sizeof(flood_band));
+	if (job.bands == NULL) { return false; }
+	for (int i = 0; i < job.num_bands; ++i) {
+		pthread_mutex_init(&job.bands[i].lock, NULL);
+		pthread_mutex_init(&job.bands[i].inbox_lock, NULL);
+		atomic_init(&job.bands[i].waiting, 0);
+	}
+	maze_parallel_for(job.num_bands, job.num_threads, clear_band, &job);
+
+	flood_item start = { row, col, 0 };
+	send_item(&job, start);
+	maze_parallel_for(job.num_threads, job.num_threads, flood_worker, &job);
+	maze_parallel_for(job.num_bands, job.num_threads, measure_band, &job);
+
+	flood->reached_cells = 0;
+	flood->levels = 0;
+	for (int i = 0; i < job.num_bands; ++i) {
+		flood->reached_cells += job.bands[i].reached_cells;
+		if (job.bands[i].reached_cells > 0 && job.bands[i].farthest + 1 > flood->levels) {
+			flood->levels = job.bands[i].farthest + 1;
+		}
+		pthread_mutex_destroy(&job.bands[i].lock);
+		pthread_mutex_destroy(&job.bands[i].inbox_lock);
+		free(job.bands[i].inbox);
+		free(job.bands[i].queue);
+	}
+	free(job.bands);
+	return !atomic_load(&job.failed);
+}
+
+// shortest path from the start cell to the goal cell, found by flooding from the goal and walking downhill
+bool maze_flood_solve(maze_flood* flood, const maze_grid* grid, int start_row, int start_col,
+		int goal_row, int goal_col, int num_threads, maze_path* path) {
+	if (start_row < 0 || start_row >= grid->height || start_col < 0 || start_col >= grid->width) { return false; }
+	bool flooded = (num_threads > 1) ? maze_flood_parallel(flood, grid, goal_row, goal_col, num_threads)
+		: maze_flood_from(flood, grid, goal_row, goal_col);
+	if (!flooded) { return false; }
+
+	uint32_t distance = maze_flood_distance(flood, grid, start_row, start_col);
+	if (distance == MAZE_FLOOD_UNREACHED) { return false; }
+	if (!maze_path_reserve(path, (long long)distance + 1)) { return false; }
+
+	// the start cell is marked as entered heading south like the entrance in solve_maze
+	int row = start_row;
+	int col = start_col;
+	int orientation = south;
+	path->length = 0;
+	while (true) {
+		maze_step* step = &path->steps[path->length++];
+		step->row = row;
+		step->col = col;
+		step->orientation = orientation;
+		if (distance == 0) { break; }
+
+		// step to the neighbor one closer to the goal
+		for (orientation = north; orientation <= west; ++orientation) {
+			if (!maze_can_move(grid, row, col, orientation)) { continue; }
+			int next_row = row + (orientation == south) - (orientation == north);
+			int next_col = col + (orientation == east) - (orientation == west);
+			if (maze_flood_distance(flood, grid, next_row, next_col) == distance - 1) {
+				row = next_row;
+				col = next_col;
+				break;
+			}
+		}
+		--distance;
+	}
+	return true;
+}
@@ -0,0 +1,97 @@
+#ifndef _MAZE_FLOOD_H_
+#define _MAZE_FLOOD_H_
+
+#include "maze_grid.h"
+#include "maze_solve.h"
+
+// +----------------------------------------------------------------------+
+// |                                                                      |
+// |                              FLOODS                                  |
+// |                                                                      |
+// +----------------------------------------------------------------------+
+
+// breadth first floods that keep the frontier and the reached cells as bitsets shaped like the
+// row major wall bitsets, so a whole word of 64 cells is moved east, west, north and south with
+// a few shifts masked by the wall words. only the words that hold part of the frontier are touched
+// on each level, which matters in mazes where the frontier is a handful of cells wide
+
+// distance of every cell the flood never reached
+#define MAZE_FLOOD_UNREACHED UINT32_MAX
+
+// rows in each band of a parallel flood, every band has a single owner at a time
+#define MAZE_FLOOD_BAND_ROWS 64
+
+// +---------------------+
+// |   TYPE DEFINITION   |
+// +---------------------+
+
+// bitsets and distances of a flood, kept between floods so only the first flood of the
+// biggest grid allocates
+typedef struct {
+	size_t words;
+	size_t cells;
+
+	uint64_t* frontier;
+	uint64_t* next;
+	uint64_t* reached;
+
+	// row major copy of the walls, only filled in for grids in another layout
+	uint64_t* south_walls;
+	uint64_t* east_walls;
+
+	// indices of the nonzero words of frontier and next
+	size_t* active;
+	size_t* next_active;
+
+	// steps from the start of the last flood to every row major cell, MAZE_FLOOD_UNREACHED when not reached
+	uint32_t* distances;
+
+	long long reached_cells;
+	long long levels;
+
+	// arena the buffers come from, NULL when they are on the heap
+	maze_arena* arena;
+} maze_flood;
+
+// +---------------+
+// |   FUNCTIONS   |
+// +---------------+
+
+// set up a flood that owns no memory yet
+void maze_flood_init(maze_flood* flood);
+// release the memory held by a flood
+void maze_flood_free(maze_flood* flood);
+
+// flood the whole maze from one cell and fill in the distance of every cell,
+// returns false when out of memory or when the cell isn't in the grid
+bool maze_flood_from(maze_flood* flood, const maze_grid* grid, int row, int col);
+
+// flood the whole maze from one cell on num_threads threads. the rows are cut into bands and a
+// thread that takes a band is the only one giving distances to its cells, cells found across the
+// edge of a band are sent to that band. the threads don't wait for each other between levels, a
+// cell that got a distance too big for it is simply given the smaller one when it arrives later.
+// returns false when out of memory or when the cell isn't in the grid
+bool maze_flood_parallel(maze_flood* flood, const maze_grid* grid, int row, int col, int num_threads);
+
+// mark every cell reachable from one cell in the reached bitset without working out distances,
+// which lets whole corridors inside a word be filled at once. returns false when out of memory
+// or when the cell isn't in the grid
+bool maze_flood_reach(maze_flood* flood, const maze_grid* grid, int row, int col);
+
+// shortest path from the start cell to the goal cell, found by flooding from the goal on num_threads
+// threads and walking downhill from the start. returns false when out of memory or when the goal
+// can't be reached
+bool maze_flood_solve(maze_flood* flood, const maze_grid* grid, int start_row, int start_col,
+	int goal_row, int goal_col, int num_threads, maze_path* path);
+
+// distance of a cell from the start of the last flood
+static inline uint32_t maze_flood_distance(const maze_flood* flood, const maze_grid* grid, int row, int col) {
+	return flood->distances[(size_t)row * grid->width + col];
+}
+
+// whether the last flood or reach got to a cell
+static inline bool maze_flood_reached(const maze_flood* flood, const maze_grid* grid, int row, int col) {
+	return maze_test_bit(flood->reached, (size_t)row * grid->words_per_row * 64 + col);
+}
+
+#endif
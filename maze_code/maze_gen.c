@@ -0,0 +1,399 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "maze_gen.h"
+#include "maze_thread.h"
+
+// +---------------+
+// |   FUNCTIONS   |
+// +---------------+
+
+// iterative recursive backtracker over the rectangle of cells starting at (top, left), the cells
+// waiting to be backtracked to are kept in an explicit heap stack instead of the call stack so
+// large mazes can't overflow it. walls on the outside of the rectangle are never touched
+static bool generate_region(maze_grid* grid, maze_rng* rng, int top, int left, int rows, int cols,
+		int start_row, int start_col) {
+
+	// stack of row major cell indices relative to the rectangle, grown as needed
+	size_t stack_size = 0;
+	size_t stack_capacity = 1024;
+	unsigned int* stack = malloc(stack_capacity * sizeof(unsigned int));
+	if (stack == NULL) { return false; }
+
+	int bottom = top + rows - 1;
+	int right = left + cols - 1;
+
+	// mark starting cell as visited
+	maze_set_visited(grid, start_row, start_col);
+	stack[stack_size++] = (unsigned int)(start_row - top) * cols + (start_col - left);
+
+	// loop that is exited when every cell has been backtracked out of
+	while (stack_size > 0) {
+		int row = top + stack[stack_size - 1] / cols;
+		int col = left + stack[stack_size - 1] % cols;
+
+		// collect the neighboring cells that are still valid movement spots,
+		// including checking for hitting the edge of the rectangle
+		int options[4];
+		int num_options = 0;
+		if (row > top     && !maze_visited(grid, row-1, col)) { options[num_options++] = north; }
+		if (col < right   && !maze_visited(grid, row, col+1)) { options[num_options++] = east; }
+		if (row < bottom  && !maze_visited(grid, row+1, col)) { options[num_options++] = south; }
+		if (col > left    && !maze_visited(grid, row, col-1)) { options[num_options++] = west; }
+
+		// when all sides relative to cell are visited, go back one cell
+		if (num_options == 0) {
+			--stack_size;
+			continue;
+		}
+
+		// pick directly from the unvisited neighbors
+		int direction = options[num_options == 1 ? 0 : maze_rng_below(rng, num_options)];
+
+		int next_row = row;
+		int next_col = col;
+		switch (direction) {
+			case north: next_row -= 1; break;
+			case east:  next_col += 1; break;
+			case south: next_row += 1; break;
+			case west:  next_col -= 1; break;
+		}
+
+		// knock down the shared wall, mark new cell as visited and push it onto the stack
+		maze_remove_wall(grid, row, col, direction);
+		maze_set_visited(grid, next_row, next_col);
+		if (stack_size == stack_capacity) {
+			stack_capacity *= 2;
+			unsigned int* grown = realloc(stack, stack_capacity * sizeof(unsigned int));
+			if (grown == NULL) {
+				free(stack);
+				return false;
+			}
+			stack = grown;
+		}
+		stack[stack_size++] = (unsigned int)(next_row - top) * cols + (next_col - left);
+	}
+
+	free(stack);
+	return true;
+}
+
+// recursive backtracker over the whole grid
+bool generate_maze(maze_grid* grid, maze_rng* rng, int start_row, int start_col, int incoming_direction) {
+	// remove wall from direction where it came from
+	maze_remove_wall(grid, start_row, start_col, (incoming_direction + 1) % 4 + 1);
+	return generate_region(grid, rng, 0, 0, grid->height, grid->width, start_row, start_col);
+}
+
+// +-----------+
+// |   TILED   |
+// +-----------+
+
+// shared state of the tile tasks
+typedef struct {
+	maze_grid* grid;
+	int tile_rows;
+	int tile_cols;
+	int tiles_across;
+	uint64_t base_seed;
+
+	atomic_int failed;
+} tile_job;
+
+// generate a single tile
+static void tile_task(int tile, void* task_data) {
+	tile_job* job = task_data;
+	maze_grid* grid = job->grid;
+
+	int top = (tile / job->tiles_across) * job->tile_rows;
+	int left = (tile % job->tiles_across) * job->tile_cols;
+	int rows = (top + job->tile_rows > grid->height) ? grid->height - top : job->tile_rows;
+	int cols = (left + job->tile_cols > grid->width) ? grid->width - left : job->tile_cols;
+
+	// every tile gets its own generator seeded from its index, so the maze only depends
+	// on the seed and tile size and not on how many threads ran or which one got the tile
+	maze_rng tile_rng;
+	maze_rng_seed(&tile_rng, job->base_seed + (uint64_t)tile * 0x9e3779b97f4a7c15ULL);
+
+	int start_row = top + maze_rng_below(&tile_rng, rows);
+	int start_col = left + maze_rng_below(&tile_rng, cols);
+	if (!generate_region(grid, &tile_rng, top, left, rows, cols, start_row, start_col)) {
+		atomic_store(&job->failed, 1);
+	}
+}
+
+// split the grid into tiles, generate every tile on its own thread, then join the tiles
+bool generate_maze_tiled(maze_grid* grid, maze_rng* rng, int num_threads, int tile_size) {
+	if (tile_size < 1) { tile_size = MAZE_TILE_SIZE; }
+
+	// tiles are a whole number of bitset words wide so no two threads ever write the same word,
+	// in morton grids a word is an 8x8 block so the tile height is rounded up as well
+	tile_job job;
+	job.grid = grid;
+	job.tile_rows = tile_size;
+	if (grid->layout == MAZE_LAYOUT_MORTON) { job.tile_rows = (tile_size + 7) / 8 * 8; }
+	job.tile_cols = (tile_size + 63) / 64 * 64;
+	job.tiles_across = (grid->width + job.tile_cols - 1) / job.tile_cols;
+	int tiles_down = (grid->height + job.tile_rows - 1) / job.tile_rows;
+	job.base_seed = maze_rng_next(rng);
+	atomic_init(&job.failed, 0);
+
+	maze_parallel_for(job.tiles_across * tiles_down, num_threads, tile_task, &job);
+
+	if (atomic_load(&job.failed)) { return false; }
+
+	// a maze over the tiles themselves is a random spanning tree of the tile graph, open exactly
+	// one random passage across the border of every pair of tiles it connects
+	maze_grid tiles;
+	if (!maze_grid_init(&tiles, job.tiles_across, tiles_down)) { return false; }
+	if (!generate_maze(&tiles, rng, 0, 0, south)) {
+		maze_grid_free(&tiles);
+		return false;
+	}
+
+	for (int tile_row = 0; tile_row < tiles_down; ++tile_row) {
+		for (int tile_col = 0; tile_col < job.tiles_across; ++tile_col) {
+			int top = tile_row * job.tile_rows;
+			int left = tile_col * job.tile_cols;
+			int rows = (top + job.tile_rows > grid->height) ? grid->height - top : job.tile_rows;
+			int cols = (left + job.tile_cols > grid->width) ? grid->width - left : job.tile_cols;
+
+			if (maze_can_move(&tiles, tile_row, tile_col, east)) {
+				maze_remove_wall(grid, top + maze_rng_below(rng, rows), left + cols - 1, east);
+			}
+			if (maze_can_move(&tiles, tile_row, tile_col, south)) {
+				maze_remove_wall(grid, top + rows - 1, left + maze_rng_below(rng, cols), south);
+			}
+		}
+	}
+
+	maze_grid_free(&tiles);
+	return true;
+}
+
+// +-------------+
+// |   KRUSKAL   |
+// +-------------+
+
+// walls between cells are numbered row major, cell * 2 for the south wall and cell * 2 + 1 for the east wall.
+// the wall list is shuffled by scattering every wall into a random bucket and then shuffling each bucket on
+// its own, which is still a uniform shuffle but lets every step run on its own block of walls or bucket
+#define KRUSKAL_BLOCK_CELLS 65536
+#define KRUSKAL_BUCKETS 256
+
+// shared state of the wall shuffle tasks
+typedef struct {
+	maze_grid* grid;
+	size_t num_cells;
+	uint64_t scatter_seed;
+	uint64_t shuffle_seed;
+
+	// walls of each block that went to each bucket, then turned into where that block writes into each bucket
+	uint32_t* block_counts;
+	// start of each bucket in the shuffled wall list
+	uint32_t* bucket_start;
+	uint32_t* walls;
+} kruskal_job;
+
+// walk over the walls of a block, handing each one a random bucket. the same block always
+// draws the same buckets, so counting and scattering can be done in two separate passes
+static void kruskal_block(kruskal_job* job, int block, bool scatter) {
+	maze_grid* grid = job->grid;
+	uint32_t* offsets = job->block_counts + (size_t)block * KRUSKAL_BUCKETS;
+
+	maze_rng block_rng;
+	maze_rng_seed(&block_rng, job->scatter_seed + (uint64_t)block * 0x9e3779b97f4a7c15ULL);
+	uint64_t buckets = 0;
+	int buckets_left = 0;
+
+	size_t first = (size_t)block * KRUSKAL_BLOCK_CELLS;
+	size_t last = first + KRUSKAL_BLOCK_CELLS;
+	if (last > job->num_cells) { last = job->num_cells; }
+
+	int row = first / grid->width;
+	int col = first % grid->width;
+	for (size_t cell = first; cell < last; ++cell) {
+		for (int side = 0; side < 2; ++side) {
+			// side 0 is the south wall, side 1 the east wall, skipping the outer border
+			if (side == 0 ? row == grid->height - 1 : col == grid->width - 1) { continue; }
+
+			if (buckets_left == 0) {
+				buckets = maze_rng_next(&block_rng);
+				buckets_left = 8;
+			}
+			int bucket = buckets & (KRUSKAL_BUCKETS - 1);
+			buckets >>= 8;
+			--buckets_left;
+
+			if (scatter) { job->walls[offsets[bucket]++] = (uint32_t)(cell * 2 + side); }
+			else { ++offsets[bucket]; }
+		}
+		if (++col == grid->width) {
+			col = 0;
+			++row;
+		}
+	}
+}
+
+static void kruskal_count_task(int block, void* task_data) {
+	kruskal_block(task_data, block, false);
+}
+
+static void kruskal_scatter_task(int block, void* task_data) {
+	kruskal_block(task_data, block, true);
+}
+
+// Fisher-Yates shuffle of a single bucket
+static void kruskal_shuffle_task(int bucket, void* task_data) {
+	kruskal_job* job = task_data;
+	uint32_t* walls = job->walls + job->bucket_start[bucket];
+	uint32_t size = job->bucket_start[bucket + 1] - job->bucket_start[bucket];
+
+	maze_rng bucket_rng;
+	maze_rng_seed(&bucket_rng, job->shuffle_seed + (uint64_t)bucket * 0x9e3779b97f4a7c15ULL);
+	for (uint32_t i = size; i > 1; --i) {
+		uint32_t j = maze_rng_below(&bucket_rng, i);
+		uint32_t temp = walls[i - 1];
+		walls[i - 1] = walls[j];
+		walls[j] = temp;
+	}
+}
+
+// root of a set of cells, halving the path on the way up
+static uint32_t kruskal_find(uint32_t* parent, uint32_t x) {
+	while (parent[x] != x) {
+		parent[x] = parent[parent[x]];
+		x = parent[x];
+	}
+	return x;
+}
+
+// randomized Kruskal, knock down walls in shuffled order whenever they separate two cells that
+// aren't connected yet. the outer border is left closed, returns false when out of memory
+bool generate_maze_kruskal(maze_grid* grid, maze_rng* rng, int num_threads) {
+	kruskal_job job;
+	job.grid = grid;
+	job.num_cells = (size_t)grid->width * grid->height;
+	job.scatter_seed = maze_rng_next(rng);
+	job.shuffle_seed = maze_rng_next(rng);
+
+	// wall numbers have to fit in 32 bits
+	if (job.num_cells > 0x7fffffff) { return false; }
+
+	size_t num_walls = (size_t)(grid->width - 1) * grid->height + (size_t)(grid->height - 1) * grid->width;
+	int num_blocks = (job.num_cells + KRUSKAL_BLOCK_CELLS - 1) / KRUSKAL_BLOCK_CELLS;
+
+	job.block_counts = calloc((size_t)num_blocks * KRUSKAL_BUCKETS, sizeof(uint32_t));
+	job.bucket_start = malloc((KRUSKAL_BUCKETS + 1) * sizeof(uint32_t));
+	job.walls = malloc((num_walls > 0 ? num_walls : 1) * sizeof(uint32_t));
+	uint32_t* parent = malloc(job.num_cells * sizeof(uint32_t));
+	uint8_t* rank = calloc(job.num_cells, sizeof(uint8_t));
+
+	bool ok = job.block_counts && job.bucket_start && job.walls && parent && rank;
+	if (ok) {
+		// count, then turn the counts into bucket major write offsets, then scatter and shuffle
+		maze_parallel_for(num_blocks, num_threads, kruskal_count_task, &job);
+
+		uint32_t total = 0;
+		for (int bucket = 0; bucket < KRUSKAL_BUCKETS; ++bucket) {
+			job.bucket_start[bucket] = total;
+			for (int block = 0; block < num_blocks; ++block) {
+				uint32_t* count = &job.block_counts[(size_t)block * KRUSKAL_BUCKETS + bucket];
+				uint32_t size = *count;
+				*count = total;
+				total += size;
+			}
+		}
+		job.bucket_start[KRUSKAL_BUCKETS] = total;
+
+		maze_parallel_for(num_blocks, num_threads, kruskal_scatter_task, &job);
+		maze_parallel_for(KRUSKAL_BUCKETS, num_threads, kruskal_shuffle_task, &job);
+
+		// every cell starts in its own set
+		for (size_t cell = 0; cell < job.num_cells; ++cell) {
+			parent[cell] = (uint32_t)cell;
+		}
+
+		// a spanning tree is done after one passage less than there are cells
+		size_t passages = 0;
+		for (size_t i = 0; i < num_walls && passages + 1 < job.num_cells; ++i) {
+			// the walls come in random order, so start pulling in the cells of an upcoming wall early
+			if (i + 16 < num_walls) {
+				uint32_t ahead = job.walls[i + 16] >> 1;
+				__builtin_prefetch(&parent[ahead]);
+				__builtin_prefetch(&parent[ahead + grid->width < job.num_cells ? ahead + grid->width : ahead]);
+			}
+
+			uint32_t wall = job.walls[i];
+			uint32_t cell = wall >> 1;
+			uint32_t neighbor = (wall & 1) ? cell + 1 : cell + grid->width;
+
+			uint32_t a = kruskal_find(parent, cell);
+			uint32_t b = kruskal_find(parent, neighbor);
+			if (a != b) {
+				// union by rank keeps the trees shallow
+				if (rank[a] < rank[b]) { parent[a] = b; }
+				else if (rank[a] > rank[b]) { parent[b] = a; }
+				else { parent[b] = a; ++rank[a]; }
+				maze_remove_wall(grid, cell / grid->width, cell % grid->width, (wall & 1) ? east : south);
+				++passages;
+			}
+		}
+	}
+
+	free(job.block_counts);
+	free(job.bucket_start);
+	free(job.walls);
+	free(parent);
+	free(rank);
+	return ok;
+}
+
+// +---------------+
+// |   DISPATCH    |
+// +---------------+
+
+// generate a complete maze into a freshly reset grid with one of the MAZE_ALGORITHM_* algorithms
+bool generate_maze_with(maze_grid* grid, maze_rng* rng, int algorithm, int num_threads) {
+	switch (algorithm) {
+		case MAZE_ALGORITHM_ELLER:
+			// stream rows straight into the grid, entrance and exit are added by the generator
+			return generate_maze_eller(grid->width, grid->height, rng, maze_row_sink_grid, grid);
+
+		case MAZE_ALGORITHM_TILED:
+		case MAZE_ALGORITHM_KRUSKAL:
+			if (algorithm == MAZE_ALGORITHM_TILED) {
+				if (!generate_maze_tiled(grid, rng, num_threads, MAZE_TILE_SIZE)) { return false; }
+			} else {
+				if (!generate_maze_kruskal(grid, rng, num_threads)) { return false; }
+			}
+			maze_remove_wall(grid, 0, 0, north); // add entrance point at top left of maze
+			break;
+
+		default:
+			// starting point for generation, entering from the north opens the entrance
+			if (!generate_maze(grid, rng, 0, 0, south)) { return false; }
+			break;
+	}
+
+	maze_remove_wall(grid, grid->height-1, grid->width-1, south); // add exit point at bottom right of maze
+	return true;
+}
+
+// command line names, indexed by algorithm number
+static const char* algorithm_names[] = { "backtracker", "eller", "tiled", "kruskal" };
+#define NUM_ALGORITHMS (int)(sizeof(algorithm_names) / sizeof(algorithm_names[0]))
+
+// algorithm number from its command line name, -1 when unknown
+int maze_algorithm_from_name(const char* name) {
+	for (int i = 0; i < NUM_ALGORITHMS; ++i) {
+		if (strcmp(name, algorithm_names[i]) == 0) { return i; }
+	}
+	return -1;
+}
+
+// command line name of an algorithm
+const char* maze_algorithm_name(int algorithm) {
+	if (algorithm < 0 || algorithm >= NUM_ALGORITHMS) { return "unknown"; }
+	return algorithm_names[algorithm];
+}
@@ -0,0 +1,49 @@
+#ifndef _MAZE_GEN_H_
+#define _MAZE_GEN_H_
+
+#include "maze_grid.h"
+#include "maze_rng.h"
+#include "maze_stream.h"
+
+// generation algorithms
+#define MAZE_ALGORITHM_BACKTRACKER 0
+#define MAZE_ALGORITHM_ELLER 1
+#define MAZE_ALGORITHM_TILED 2
+#define MAZE_ALGORITHM_KRUSKAL 3
+
+// default edge length of the square tiles used by tiled generation
+#define MAZE_TILE_SIZE 256
+
+// +----------------------------------------------------------------------+
+// |                                                                      |
+// |                           GENERATION                                 |
+// |                                                                      |
+// +----------------------------------------------------------------------+
+
+// +---------------+
+// |   FUNCTIONS   |
+// +---------------+
+
+// recursive backtracker starting from the given cell, entering it from incoming_direction.
+// backtracking state is kept in an explicit heap stack, returns false when out of memory
+bool generate_maze(maze_grid* grid, maze_rng* rng, int start_row, int start_col, int incoming_direction);
+
+// split the grid into tiles of roughly tile_size cells square, run the backtracker on each tile on
+// num_threads threads, then join the tiles through a random spanning tree of the tile graph so the
+// result is still a perfect maze. the outer border is left closed. returns false when out of memory
+bool generate_maze_tiled(maze_grid* grid, maze_rng* rng, int num_threads, int tile_size);
+
+// randomized Kruskal with union find, the wall list is shuffled on num_threads threads.
+// the outer border is left closed, grids are limited to 2^31 cells. returns false when out of memory
+bool generate_maze_kruskal(maze_grid* grid, maze_rng* rng, int num_threads);
+
+// generate a complete maze into a freshly reset grid with one of the MAZE_ALGORITHM_* algorithms,
+// with the entrance at the top left and the exit at the bottom right. returns false when out of memory
+bool generate_maze_with(maze_grid* grid, maze_rng* rng, int algorithm, int num_threads);
+
+// algorithm number from its command line name, -1 when unknown
+int maze_algorithm_from_name(const char* name);
+// command line name of an algorithm
+const char* maze_algorithm_name(int algorithm);
+
+#endif
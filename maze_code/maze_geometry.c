@@ -0,0 +1,810 @@
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include "maze_geometry.h"
+
+// +---------------+
+// |   FUNCTIONS   |
+// +---------------+
+
+// set up empty geometry, nothing is allocated until it is built
+void maze_geometry_init(maze_geometry* geometry) {
+	maze_geometry_init_arena(geometry, NULL);
+}
+
+// set up empty geometry whose vertices and texture coordinates will come out of an arena
+void maze_geometry_init_arena(maze_geometry* geometry, maze_arena* arena) {
+	geometry->num_floor_verts = 0;
+	geometry->num_pole_verts = 0;
+	geometry->num_wall_verts = 0;
+	geometry->maze_verts = 0;
+	geometry->vertices = NULL;
+	geometry->tex_coords = NULL;
+	geometry->instances = NULL;
+	geometry->max_instances = 0;
+	for (int kind = 0; kind < MAZE_CUBE_KINDS; ++kind) {
+		geometry->first_instance[kind] = 0;
+		geometry->num_instances[kind] = 0;
+	}
+	geometry->mesh_vertices = NULL;
+	geometry->mesh_indices = NULL;
+	geometry->mesh_index_size = 2;
+	geometry->mesh_capacity = 0;
+	geometry->chunks = NULL;
+	geometry->chunks_down = 0;
+	geometry->chunks_across = 0;
+	geometry->num_chunks = 0;
+	geometry->lod_first_face = 0;
+	geometry->wall_bits = NULL;
+	geometry->wall_bits_width = 0;
+	geometry->wall_bits_height = 0;
+	geometry->line_tranforms = NULL;
+	geometry->anim_tranforms = NULL;
+	geometry->num_lines = 0;
+	geometry->arena = arena;
+}
+
+// release the memory held by the geometry
+void maze_geometry_free(maze_geometry* geometry) {
+	maze_arena* arena = geometry->arena;
+	maze_release(arena, geometry->vertices);
+	maze_release(arena, geometry->tex_coords);
+	maze_release(arena, geometry->instances);
+	maze_release(arena, geometry->mesh_vertices);
+	maze_release(arena, geometry->mesh_indices);
+	maze_release(arena, geometry->chunks);
+	maze_release(arena, geometry->wall_bits);
+	free(geometry->line_tranforms);
+	free(geometry->anim_tranforms);
+	maze_geometry_init_arena(geometry, arena);
+}
+
+// transform that centers the maze on screen, scales it to fit and rotates it to make north up
+mat4 maze_geometry_fit_xform(const maze_grid* grid) {
+	int longest_side = (grid->width > grid->height) ? grid->width : grid->height;
+	float fit_scale = 1.8f / (float)(longest_side + 1);
+
+	return mat_mult(xform_rot_mat('z', -3.14159f/2.0f),
+		mat_mult(xform_scale_mat(fit_scale, fit_scale, fit_scale),
+			xform_trans_mat(-(grid->height + 1) / 2.0f, -(grid->width + 1) / 2.0f, 0.0f)));
+}
+
+// fill in the texture coordinates of every 6 vert face of one section of the vertex array
+static void build_tex_coords(float (*tex_coords)[2], int first, int last, float u, float v) {
+	for (int i = first; i < last; /**/) {
+		tex_coords[i][0] = 0.0f + u;
+		tex_coords[i][1] = 0.0f + v;
+		++i;
+		tex_coords[i][0] = 0.0f + u;
+		tex_coords[i][1] = 0.5f + v;
+		++i;
+		tex_coords[i][0] = 0.5f + u;
+		tex_coords[i][1] = 0.5f + v;
+		++i;
+		tex_coords[i][0] = 0.0f + u;
+		tex_coords[i][1] = 0.0f + v;
+		++i;
+		tex_coords[i][0] = 0.5f + u;
+		tex_coords[i][1] = 0.5f + v;
+		++i;
+		tex_coords[i][0] = 0.5f + u;
+		tex_coords[i][1] = 0.0f + v;
+		++i;
+	}
+}
+
+// build one unit cube of each MAZE_CUBE_* kind, centered on the origin of the floor
+static void build_cubes(vec4 cubes[MAZE_CUBE_KINDS][36]) {
+
+	// ---------- GENERATE BASE CUBE ----------
+
+	// create initial square face
+	vec4 base_cube[36] = {
+	{ -0.5f,  0.5f, 0.5f, 1.0f }, // top left
+	{ -0.5f, -0.5f, 0.5f, 1.0f }, // bot left
+	{  0.5f, -0.5f, 0.5f, 1.0f }, // bot right
+	{ -0.5f,  0.5f, 0.5f, 1.0f }, // top left
+	{  0.5f, -0.5f, 0.5f, 1.0f }, // bot right
+	{  0.5f,  0.5f, 0.5f, 1.0f }, // top right
+	};
+
+	// copy and rotate inital cube to form full cube
+	// SIDE COMMENTS ARE RELATIVE TO DEFAULT CAMERA VIEW
+
+	int offset = 6;
+	float pi = 3.14159;
+	mat4 curr_xform = xform_rot_mat('x', pi/2);
+
+	// bottom
+	for (int i = 0; i < 6; ++i) {
+		base_cube[i + offset] = mat_vec_mult(curr_xform, base_cube[i]);
+	}
+	// right
+	offset += 6;
+	curr_xform = xform_rot_mat('z', pi/2);
+	for (int i = 0; i < 6; ++i) {
+		base_cube[i + offset] = mat_vec_mult(curr_xform, base_cube[i + 6]);
+	}
+	// top
+	offset += 6;
+	for (int i = 0; i < 6; ++i) {
+		base_cube[i + offset] = mat_vec_mult(curr_xform, base_cube[i + 12]);
+	}
+	// left
+	offset += 6;
+	for (int i = 0; i < 6; ++i) {
+		base_cube[i + offset] = mat_vec_mult(curr_xform, base_cube[i + 18]);
+	}
+	// back
+	offset += 6;
+	curr_xform = xform_rot_mat('y', -pi/2);
+	for (int i = 0; i < 6; ++i) {
+		base_cube[i + offset] = mat_vec_mult(curr_xform, base_cube[i + 24]);
+	}
+
+	// ------------------------------------------------------------------------
+	// ---------- CUSTOMIZE CUBES FOR WALLS, FLOOR, POLES, AND LINES ----------
+	// ------------------------------------------------------------------------
+
+	// arrays to hold each base cube
+	vec4* floor_cube = cubes[MAZE_CUBE_FLOOR];
+	vec4* pole_cube = cubes[MAZE_CUBE_POLE];
+	vec4* wall_cube = cubes[MAZE_CUBE_WALL];
+	vec4* line_cube = cubes[MAZE_CUBE_LINE];
+
+	// -------------------- FLOOR --------------------
+	// create floor cube base by translating cube down .5 z units to align top with xy axis
+	curr_xform = xform_trans_mat(0.0f, 0.0f, -0.5f);
+	for (int i = 0; i < 36; ++i) {
+		floor_cube[i] = mat_vec_mult(curr_xform, base_cube[i]);
+	}
+
+	// -------------------- POLE --------------------
+	// create pole cube by moving up so bottom lies on xy axis, then scale down on x and y axis
+	curr_xform = mat_mult(xform_scale_mat(0.25f, 0.25f, 1.0f), xform_trans_mat(0.0f, 0.0f, 0.5f));
+	for (int i = 0; i < 36; ++i) {
+		pole_cube[i] = mat_vec_mult(curr_xform, base_cube[i]);
+	}
+
+	// -------------------- WALL --------------------
+	// create wall cube by moving up bottom slightly less thatn .5 units, then scaling to be thin on one axis
+	// NOTE: WALL IS THIN ON THE Y AXIS
+	curr_xform = mat_mult(xform_scale_mat(1.0f, 0.1f, 1.0f), xform_trans_mat(0.0f, 0.0f, 0.4f));
+	for (int i = 0; i < 36; ++i) {
+		wall_cube[i] = mat_vec_mult(curr_xform, base_cube[i]);
+	}
+
+	// -------------------- LINE --------------------
+	// create line cube by aligning with __________ axis and scaling to proper length
+	//curr_xform = mat_mult(xform_scale_mat(1.0f, 0.5f, 1.0f), mat_mult(xform_trans_mat(0.0f, -0.5f, 0.4f), xform_scale_mat(0.25f, 1.0f, 0.25f)));
+	curr_xform = mat_mult(xform_trans_mat(0.0f, -0.5f, 0.8f), xform_scale_mat(0.25f, 1.0f, 0.25f));
+	for (int i = 0; i < 36; ++i) {
+		line_cube[i] = mat_vec_mult(curr_xform, base_cube[i]);
+	}
+	// lines are drawn turned a quarter turn like the horizontal walls
+	curr_xform = xform_rot_mat('z', 3.14159f/2.0f);
+	for (int i = 0; i < 36; ++i) {
+		line_cube[i] = mat_vec_mult(curr_xform, line_cube[i]);
+	}
+}
+
+// build the vertices of every wall that is up
+bool maze_geometry_build(maze_geometry* geometry, const maze_grid* grid) {
+
+	// size the vertex array for a maze of the current dimensions. the counts are handed to GL as a GLsizei,
+	// which is an int, so mazes with more verts than that can't be baked
+	size_t height = grid->height, width = grid->width;
+	size_t floor_verts = 36 * (height + 2) * (width + 2);
+	size_t pole_verts = 36 * (height + 1) * (width + 1);
+	size_t wall_verts = 36 * ((height + 1) * width + (width + 1) * height);
+	if (floor_verts + pole_verts + wall_verts + 36 > INT_MAX) { return false; }
+	int num_floor_verts = floor_verts;
+	int num_pole_verts = pole_verts;
+	int num_wall_verts = wall_verts;
+	int maze_verts = num_floor_verts + num_pole_verts + num_wall_verts;
+
+	// the size only depends on the maze dimensions, so edits build the geometry again in the same array,
+	// and the texture coordinates only depend on the sections so they are only built once
+	if (geometry->vertices == NULL) {
+		geometry->num_floor_verts = num_floor_verts;
+		geometry->num_pole_verts = num_pole_verts;
+		geometry->num_wall_verts = num_wall_verts;
+		geometry->maze_verts = maze_verts;
+
+		geometry->vertices = maze_alloc(geometry->arena, (size_t)(maze_verts + 36) * sizeof(vec4));
+		geometry->tex_coords = maze_calloc(geometry->arena, maze_verts + 36, sizeof(*geometry->tex_coords));
+		if (geometry->vertices == NULL || geometry->tex_coords == NULL) {
+			maze_geometry_free(geometry);
+			return false;
+		}
+
+		build_tex_coords(geometry->tex_coords, 0, num_floor_verts, 0.0f, 0.5f);
+		build_tex_coords(geometry->tex_coords, num_floor_verts, num_floor_verts + num_pole_verts, 0.5f, 0.0f);
+		build_tex_coords(geometry->tex_coords, num_floor_verts + num_pole_verts, maze_verts, 0.0f, 0.0f);
+	}
+	vec4* vertices = geometry->vertices;
+	memset(vertices, 0, (size_t)(maze_verts + 36) * sizeof(vec4));
+
+	// one unit cube of each kind, copied and moved into place for every part of the maze
+	vec4 cubes[MAZE_CUBE_KINDS][36];
+	build_cubes(cubes);
+	vec4* floor_cube = cubes[MAZE_CUBE_FLOOR];
+	vec4* pole_cube = cubes[MAZE_CUBE_POLE];
+	vec4* wall_cube = cubes[MAZE_CUBE_WALL];
+	vec4* line_cube = cubes[MAZE_CUBE_LINE];
+	mat4 curr_xform;
+
+	// -----------------------------------------------------------
+	// ---------- COPY AND TRANSFORM CUBES TO FORM MAZE ----------
+	// -----------------------------------------------------------
+
+	// NOTE: maze is fomed in the +x -y quadrant of the xy plane to make construction easier by being able to directly
+	// take maze cell coordinates and place things
+
+	// GROUND
+	int index = 0;
+	for (int i = 0; i < grid->height + 2; ++i) {
+		for (int j = 0; j < grid->width + 2; ++j) {
+			for (int k = 0; k < 36; ++k) {
+				vertices[index] = floor_cube[k];
+				// move cube in one unit increments to form a floor
+				vertices[index].x += i;
+				vertices[index].y += j;
+				++index;
+			}
+		}
+	}
+
+	// POLES
+	for (int i = 0; i < grid->height + 1; ++i) {
+		for (int j = 0; j < grid->width + 1; ++j) {
+			for (int k = 0; k < 36; ++k) {
+				vertices[index] = pole_cube[k];
+				vertices[index].x += i + 0.5f;
+				vertices[index].y += j + 0.5f;
+				++index;
+			}
+		}
+	}
+
+	// VERTICAL WALLS
+	for (int i = 0; i < grid->height; ++i) {
+		for (int j = 0; j < grid->width; ++j) {
+			for (int k = 0; k < 36; ++k) {
+				if (maze_has_wall(grid, i, j, west)) {
+					vertices[index] = wall_cube[k];
+					vertices[index].x += i + 1.0f;
+					vertices[index].y += j + 0.5f;
+					++index;
+				}
+			}
+		}
+	}
+	for (int i = 0; i < grid->height; ++i) {
+		for (int j = 0; j < 36; ++j) {
+			if (maze_has_wall(grid, i, grid->width-1, east)) {
+				vertices[index] = wall_cube[j];
+				vertices[index].x += i + 1.0f;
+				vertices[index].y += grid->width + 0.5f;
+				++index;
+			}
+		}
+	}
+	// HORIZONTAL WALLS
+	curr_xform = xform_rot_mat('z', 3.14159f/2.0f);
+	for (int i = 0; i < grid->height; ++i) {
+		for (int j = 0; j < grid->width; ++j) {
+			for (int k = 0; k < 36; ++k) {
+				if (maze_has_wall(grid, i, j, north)) {
+					vertices[index] = mat_vec_mult(curr_xform, wall_cube[k]);
+					vertices[index].x += i + 0.5f;
+					vertices[index].y += j + 1.0f;
+					++index;
+				}
+			}
+		}
+	}
+	for (int i = 0; i < grid->width; ++i) {
+		for (int j = 0; j < 36; ++j) {
+			if (maze_has_wall(grid, grid->height-1, i, south)) {
+				vertices[index] = mat_vec_mult(curr_xform, wall_cube[j]);
+				vertices[index].x += grid->height + 0.5f;
+				vertices[index].y += i + 1.0f;
+				++index;
+			}
+		}
+	}
+
+
+	index = maze_verts;
+	// TEST CUBE
+	for (int i = 0; i < 36; ++i) {
+		vertices[index] = line_cube[i];
+		index++;
+	}
+
+	// center on screen, scale to fit screen and rotate to make north up
+	curr_xform = maze_geometry_fit_xform(grid);
+	for (int i = 0; i < maze_verts; ++i) {
+		vertices[i] = mat_vec_mult(curr_xform, vertices[i]);
+	}
+	return true;
+}
+
+// add an instance of a unit cube
+static inline void add_instance(maze_instance** instance, float x, float y, float turns) {
+	(*instance)->x = x;
+	(*instance)->y = y;
+	(*instance)->turns = turns;
+	++*instance;
+}
+
+// build the unit cubes and an instance of every floor tile, pole and wall that is up
+bool maze_geometry_build_instances(maze_geometry* geometry, const maze_grid* grid) {
+	// instance counts are handed to GL as a GLsizei, which is an int
+	size_t height = grid->height, width = grid->width;
+	size_t floors = (height + 2) * (width + 2);
+	size_t poles = (height + 1) * (width + 1);
+	size_t walls = (height + 1) * width + (width + 1) * height;
+	if (floors + poles + walls > INT_MAX) { return false; }
+	int num_floors = floors;
+	int num_poles = poles;
+	int max_walls = walls;
+
+	// the floor and poles never change, so they are only placed along with the cubes
+	if (geometry->instances == NULL) {
+		geometry->max_instances = num_floors + num_poles + max_walls;
+		geometry->instances = maze_alloc(geometry->arena, (size_t)geometry->max_instances * sizeof(maze_instance));
+		if (geometry->instances == NULL) {
+			geometry->max_instances = 0;
+			return false;
+		}
+
+		vec4 cubes[MAZE_CUBE_KINDS][36];
+		build_cubes(cubes);
+		memcpy(geometry->cube_vertices, cubes, sizeof(cubes));
+		memset(geometry->cube_tex_coords, 0, sizeof(geometry->cube_tex_coords));
+		build_tex_coords(geometry->cube_tex_coords, MAZE_CUBE_FLOOR * 36, MAZE_CUBE_FLOOR * 36 + 36, 0.0f, 0.5f);
+		build_tex_coords(geometry->cube_tex_coords, MAZE_CUBE_POLE * 36, MAZE_CUBE_POLE * 36 + 36, 0.5f, 0.0f);
+		build_tex_coords(geometry->cube_tex_coords, MAZE_CUBE_WALL * 36, MAZE_CUBE_WALL * 36 + 36, 0.0f, 0.0f);
+
+		// the same places the baked geometry moves its cubes to
+		maze_instance* instance = geometry->instances;
+		for (int i = 0; i < grid->height + 2; ++i) {
+			for (int j = 0; j < grid->width + 2; ++j) {
+				add_instance(&instance, i, j, 0.0f);
+			}
+		}
+		for (int i = 0; i < grid->height + 1; ++i) {
+			for (int j = 0; j < grid->width + 1; ++j) {
+				add_instance(&instance, i + 0.5f, j + 0.5f, 0.0f);
+			}
+		}
+		geometry->first_instance[MAZE_CUBE_FLOOR] = 0;
+		geometry->num_instances[MAZE_CUBE_FLOOR] = num_floors;
+		geometry->first_instance[MAZE_CUBE_POLE] = num_floors;
+		geometry->num_instances[MAZE_CUBE_POLE] = num_poles;
+		geometry->first_instance[MAZE_CUBE_WALL] = num_floors + num_poles;
+		geometry->first_instance[MAZE_CUBE_LINE] = num_floors + num_poles;
+		geometry->num_instances[MAZE_CUBE_LINE] = 0;
+	}
+
+	// walls are thin on the y axis, the horizontal ones are turned a quarter turn
+	maze_instance* instance = geometry->instances + geometry->first_instance[MAZE_CUBE_WALL];
+	for (int i = 0; i < grid->height; ++i) {
+		for (int j = 0; j < grid->width; ++j) {
+			if (maze_has_wall(grid, i, j, west)) { add_instance(&instance, i + 1.0f, j + 0.5f, 0.0f); }
+		}
+		if (maze_has_wall(grid, i, grid->width - 1, east)) { add_instance(&instance, i + 1.0f, grid->width + 0.5f, 0.0f); }
+	}
+	for (int i = 0; i < grid->height; ++i) {
+		for (int j = 0; j < grid->width; ++j) {
+			if (maze_has_wall(grid, i, j, north)) { add_instance(&instance, i + 0.5f, j + 1.0f, 1.0f); }
+		}
+	}
+	for (int i = 0; i < grid->width; ++i) {
+		if (maze_has_wall(grid, grid->height - 1, i, south)) { add_instance(&instance, grid->height + 0.5f, i + 1.0f, 1.0f); }
+	}
+	geometry->num_instances[MAZE_CUBE_WALL] = instance - (geometry->instances + geometry->first_instance[MAZE_CUBE_WALL]);
+	return true;
+}
+
+// faces of the unit cubes by the side of the cube they are on, in the order build_cubes lays them out
+#define FACE_TOP (1 << 0)
+#define FACE_LOW_Y (1 << 1)
+#define FACE_HIGH_X (1 << 2)
+#define FACE_HIGH_Y (1 << 3)
+#define FACE_LOW_X (1 << 4)
+#define FACE_BOTTOM (1 << 5)
+#define FACE_SIDES (FACE_LOW_Y | FACE_HIGH_X | FACE_HIGH_Y | FACE_LOW_X)
+
+// the 4 distinct verts of the 6 verts of a cube face, which is two triangles sharing the first and third
+static const int face_corner_verts[4] = { 0, 1, 2, 5 };
+// the corner of the texture tile each of those verts sits on
+static const float face_corners[4][2] = { { 0, 0 }, { 0, 1 }, { 1, 1 }, { 1, 0 } };
+// the two triangles of a face as corners, wound the same way as the cube
+static const int face_triangles[6] = { 0, 1, 2, 0, 2, 3 };
+
+// axis a cube face runs along between two of its verts, 0 for x and 1 for y and 2 for z
+static int face_axis(vec4 from, vec4 to) {
+	float dx = fabsf(to.x - from.x), dy = fabsf(to.y - from.y), dz = fabsf(to.z - from.z);
+	if (dx >= dy && dx >= dz) { return 0; }
+	return (dy >= dz) ? 1 : 2;
+}
+
+// append the faces in face_mask of a unit cube of the given kind, stretched to cover stretch[0] by stretch[1]
+// tiles, then turned by quarter turns and moved to (x, y). every tile the stretched faces cover gets a whole
+// texture tile, so a stretched box looks the same as a row of unit cubes. positions are stored as steps of
+// scale from offset. returns the number of faces added
+static int add_box(maze_mesh_vertex* vertices, const vec4 cubes[MAZE_CUBE_KINDS][36], int kind, const float stretch[2],
+		int turns, float x, float y, int face_mask, float scale, const float offset[3]) {
+	int added = 0;
+	for (int face = 0; face < 6; ++face) {
+		if (!(face_mask & (1 << face))) { continue; }
+		const vec4* verts = cubes[kind] + face * 6;
+
+		// tiles covered along the axes the texture coordinates run along, the thickness is always one tile
+		float repeat[3] = { stretch[0], stretch[1], 1.0f };
+		float u_tiles = repeat[face_axis(verts[0], verts[5])];
+		float v_tiles = repeat[face_axis(verts[0], verts[1])];
+
+		for (int corner = 0; corner < 4; ++corner) {
+			vec4 vertex = verts[face_corner_verts[corner]];
+			vertex.x *= stretch[0];
+			vertex.y *= stretch[1];
+			if (turns & 1) {
+				float turned = -vertex.y;
+				vertex.y = vertex.x;
+				vertex.x = turned;
+			}
+
+			maze_mesh_vertex* out = &vertices[added * 4 + corner];
+			out->x = lrintf((vertex.x + x - offset[0]) / scale);
+			out->y = lrintf((vertex.y + y - offset[1]) / scale);
+			out->z = lrintf((vertex.z - offset[2]) / scale);
+			out->u = kind * MAZE_MESH_KIND_TILES + face_corners[corner][0] * u_tiles;
+			out->v = face_corners[corner][1] * v_tiles;
+		}
+		++added;
+	}
+	return added;
+}
+
+// whether the wall along the line between columns j - 1 and j is up in row i, j is width for the east border
+static inline bool column_wall(const maze_grid* grid, int i, int j) {
+	return (j < grid->width) ? maze_has_wall(grid, i, j, west) : maze_has_wall(grid, i, grid->width - 1, east);
+}
+
+// whether the wall along the line between rows i - 1 and i is up in column j, i is height for the south border
+static inline bool row_wall(const maze_grid* grid, int i, int j) {
+	return (i < grid->height) ? maze_has_wall(grid, i, j, north) : maze_has_wall(grid, grid->height - 1, j, south);
+}
+
+// the floor tiles under a chunk along one axis, the chunks on the edges also cover the border tiles
+static void chunk_tiles(int first, int count, int size, int* low, int* high) {
+	*low = (first == 0) ? 0 : first + 1;
+	*high = (first + count == size) ? size + 1 : first + count;
+}
+
+// rebuild the merged runs of walls of one chunk. walls run from the middle of one pole to the middle of the
+// next, so their ends are always inside a pole and their bottoms inside the floor. every straight run of
+// walls inside the chunk becomes one box
+static void build_chunk_walls(maze_geometry* geometry, const maze_grid* grid, maze_chunk* chunk,
+		const vec4 cubes[MAZE_CUBE_KINDS][36]) {
+	maze_mesh_vertex* vertices = geometry->mesh_vertices + 4 * (chunk->first_face + chunk->fixed_faces);
+	const float scale = 1.0f / MAZE_MESH_STEPS;
+	int last_row = chunk->row + chunk->rows;
+	int last_col = chunk->col + chunk->cols;
+	int used = 0;
+	int wall_faces = FACE_TOP | FACE_LOW_Y | FACE_HIGH_Y;
+
+	// walls between columns, down each line between two columns including the east border
+	int last_line = (last_col == grid->width) ? last_col : last_col - 1;
+	for (int j = chunk->col; j <= last_line; ++j) {
+		for (int i = chunk->row; i < last_row; /**/) {
+			if (!column_wall(grid, i, j)) { ++i; continue; }
+
+			int run = 1;
+			while (i + run < last_row && column_wall(grid, i + run, j)) { ++run; }
+			const float stretch[2] = { run, 1.0f };
+			used += add_box(vertices + 4 * used, cubes, MAZE_CUBE_WALL, stretch, 0, i + run / 2.0f + 0.5f, j + 0.5f,
+				wall_faces, scale, chunk->offset);
+			i += run;
+		}
+	}
+	// walls between rows, along each line between two rows including the south border
+	last_line = (last_row == grid->height) ? last_row : last_row - 1;
+	for (int i = chunk->row; i <= last_line; ++i) {
+		for (int j = chunk->col; j < last_col; /**/) {
+			if (!row_wall(grid, i, j)) { ++j; continue; }
+
+			int run = 1;
+			while (j + run < last_col && row_wall(grid, i, j + run)) { ++run; }
+			const float stretch[2] = { run, 1.0f };
+			used += add_box(vertices + 4 * used, cubes, MAZE_CUBE_WALL, stretch, 1, i + 0.5f, j + run / 2.0f + 0.5f,
+				wall_faces, scale, chunk->offset);
+			j += run;
+		}
+	}
+	chunk->wall_faces = used;
+}
+
+// fill in the wall bits of every wall
+static void build_wall_bits(maze_geometry* geometry, const maze_grid* grid) {
+	unsigned char* bits = geometry->wall_bits;
+	int stride = geometry->wall_bits_width;
+	for (int i = 0; i <= grid->height; ++i) {
+		for (int j = 0; j <= grid->width; ++j) {
+			if (i < grid->height) { bits[(2 * i + 1) * stride + 2 * j] = column_wall(grid, i, j) ? 255 : 0; }
+			if (j < grid->width) { bits[2 * i * stride + 2 * j + 1] = row_wall(grid, i, j) ? 255 : 0; }
+		}
+	}
+}
+
+// lay out the chunks and allocate the mesh for the most faces they can need, then fill in the indices of
+// every one of them, the poles and the floor of every chunk and the far quads
+static bool alloc_mesh(maze_geometry* geometry, const maze_grid* grid, const vec4 cubes[MAZE_CUBE_KINDS][36]) {
+	int height = grid->height;
+	int width = grid->width;
+	geometry->chunks_down = (height + MAZE_CHUNK_CELLS - 1) / MAZE_CHUNK_CELLS;
+	geometry->chunks_across = (width + MAZE_CHUNK_CELLS - 1) / MAZE_CHUNK_CELLS;
+	geometry->num_chunks = geometry->chunks_down * geometry->chunks_across;
+	geometry->chunks = maze_alloc(geometry->arena, geometry->num_chunks * sizeof(maze_chunk));
+
+	// far quads are only worth it when the wall bits can be kept
+	bool far_quads = 2 * height + 1 <= MAZE_WALL_BITS_MAX && 2 * width + 1 <= MAZE_WALL_BITS_MAX;
+	if (far_quads) {
+		// padded with floor to powers of two, so every mip level averages whole cells
+		geometry->wall_bits_width = 1;
+		geometry->wall_bits_height = 1;
+		while (geometry->wall_bits_width < 2 * width + 1) { geometry->wall_bits_width *= 2; }
+		while (geometry->wall_bits_height < 2 * height + 1) { geometry->wall_bits_height *= 2; }
+		geometry->wall_bits = maze_calloc(geometry->arena, (size_t)geometry->wall_bits_width * geometry->wall_bits_height, 1);
+	}
+
+	// the line cube and the far quads, then for every chunk the floor piece, 5 faces per pole and 3 per run
+	// of walls. the most runs fit on a line when every other wall along it is up
+	long long max_faces = 6 + 2LL * geometry->num_chunks;
+	for (int down = 0; down < geometry->chunks_down; ++down) {
+		for (int across = 0; across < geometry->chunks_across; ++across) {
+			int row = down * MAZE_CHUNK_CELLS, col = across * MAZE_CHUNK_CELLS;
+			int rows = (height - row < MAZE_CHUNK_CELLS) ? height - row : MAZE_CHUNK_CELLS;
+			int cols = (width - col < MAZE_CHUNK_CELLS) ? width - col : MAZE_CHUNK_CELLS;
+			int pole_rows = rows + ((row + rows == height) ? 1 : 0);
+			int pole_cols = cols + ((col + cols == width) ? 1 : 0);
+			int max_runs = pole_cols * ((rows + 1) / 2) + pole_rows * ((cols + 1) / 2);
+			// the top and bottom of the floor piece and the sides it has on the border of the maze
+			int floor_faces = 2 + (row == 0) + (row + rows == height) + (col == 0) + (col + cols == width);
+
+			if (geometry->chunks != NULL) {
+				maze_chunk* chunk = &geometry->chunks[down * geometry->chunks_across + across];
+				chunk->row = row;
+				chunk->col = col;
+				chunk->rows = rows;
+				chunk->cols = cols;
+				chunk->first_face = max_faces;
+				chunk->fixed_faces = floor_faces + 5 * pole_rows * pole_cols;
+				chunk->wall_faces = 0;
+				chunk->max_wall_faces = 3 * max_runs;
+				max_faces += chunk->fixed_faces + chunk->max_wall_faces;
+			}
+		}
+	}
+	geometry->mesh_capacity = max_faces;
+	geometry->mesh_index_size = (4 * max_faces <= 65536) ? 2 : 4;
+	geometry->lod_first_face = 6;
+
+	// zeroed, since the room left for walls is uploaded along with the rest
+	geometry->mesh_vertices = maze_calloc(geometry->arena, 4 * max_faces, sizeof(maze_mesh_vertex));
+	geometry->mesh_indices = maze_alloc(geometry->arena, 6 * max_faces * geometry->mesh_index_size);
+	if (geometry->chunks == NULL || geometry->mesh_vertices == NULL || geometry->mesh_indices == NULL
+			|| (far_quads && geometry->wall_bits == NULL)) {
+		maze_release(geometry->arena, geometry->chunks);
+		maze_release(geometry->arena, geometry->wall_bits);
+		maze_release(geometry->arena, geometry->mesh_vertices);
+		maze_release(geometry->arena, geometry->mesh_indices);
+		geometry->chunks = NULL;
+		geometry->wall_bits = NULL;
+		geometry->mesh_vertices = NULL;
+		geometry->mesh_indices = NULL;
+		geometry->num_chunks = 0;
+		geometry->mesh_capacity = 0;
+		return false;
+	}
+
+	// the indices of a face only depend on how many faces come before it
+	for (long long face = 0; face < max_faces; ++face) {
+		for (int k = 0; k < 6; ++k) {
+			unsigned int index = 4 * face + face_triangles[k];
+			if (geometry->mesh_index_size == 2) { ((unsigned short*)geometry->mesh_indices)[6 * face + k] = index; }
+			else { ((unsigned int*)geometry->mesh_indices)[6 * face + k] = index; }
+		}
+	}
+
+	// the line cube is centered on its own origin
+	const float unit[2] = { 1.0f, 1.0f };
+	const float no_offset[3] = { 0.0f, 0.0f, 0.0f };
+	add_box(geometry->mesh_vertices, cubes, MAZE_CUBE_LINE, unit, 0, 0.0f, 0.0f, FACE_TOP | FACE_SIDES | FACE_BOTTOM,
+		1.0f / MAZE_MESH_STEPS, no_offset);
+	if (!far_quads) { memset(geometry->mesh_vertices + 4 * 6, 0, 4 * 2 * geometry->num_chunks * sizeof(maze_mesh_vertex)); }
+
+	for (int c = 0; c < geometry->num_chunks; ++c) {
+		maze_chunk* chunk = &geometry->chunks[c];
+		int low_x, high_x, low_y, high_y;
+		chunk_tiles(chunk->row, chunk->rows, height, &low_x, &high_x);
+		chunk_tiles(chunk->col, chunk->cols, width, &low_y, &high_y);
+		const float tiles[2] = { high_x - low_x + 1, high_y - low_y + 1 };
+		float center_x = (low_x + high_x) / 2.0f, center_y = (low_y + high_y) / 2.0f;
+		chunk->offset[0] = center_x;
+		chunk->offset[1] = center_y;
+		chunk->offset[2] = 0.0f;
+
+		// the floor piece keeps the sides on the border of the maze, the bottom of every pole sits on the floor
+		maze_mesh_vertex* vertices = geometry->mesh_vertices + 4 * chunk->first_face;
+		int faces = FACE_TOP | FACE_BOTTOM;
+		if (chunk->row == 0) { faces |= FACE_LOW_X; }
+		if (chunk->row + chunk->rows == height) { faces |= FACE_HIGH_X; }
+		if (chunk->col == 0) { faces |= FACE_LOW_Y; }
+		if (chunk->col + chunk->cols == width) { faces |= FACE_HIGH_Y; }
+		int used = add_box(vertices, cubes, MAZE_CUBE_FLOOR, tiles, 0, center_x, center_y, faces,
+			1.0f / MAZE_MESH_STEPS, chunk->offset);
+
+		int last_pole_row = chunk->row + chunk->rows - ((chunk->row + chunk->rows == height) ? 0 : 1);
+		int last_pole_col = chunk->col + chunk->cols - ((chunk->col + chunk->cols == width) ? 0 : 1);
+		for (int i = chunk->row; i <= last_pole_row; ++i) {
+			for (int j = chunk->col; j <= last_pole_col; ++j) {
+				used += add_box(vertices + 4 * used, cubes, MAZE_CUBE_POLE, unit, 0, i + 0.5f, j + 0.5f,
+					FACE_TOP | FACE_SIDES, 1.0f / MAZE_MESH_STEPS, chunk->offset);
+			}
+		}
+		// the box around the floor piece and the poles also holds every wall
+		for (int axis = 0; axis < 3; ++axis) {
+			chunk->min[axis] = 1e30f;
+			chunk->max[axis] = -1e30f;
+		}
+		for (int k = 0; k < 4 * used; ++k) {
+			const short* steps = &vertices[k].x;
+			for (int axis = 0; axis < 3; ++axis) {
+				float position = chunk->offset[axis] + steps[axis] / (float)MAZE_MESH_STEPS;
+				if (position < chunk->min[axis]) { chunk->min[axis] = position; }
+				if (position > chunk->max[axis]) { chunk->max[axis] = position; }
+			}
+		}
+
+		// the far quad is the top and bottom of the floor piece, colored from the wall bits
+		if (far_quads) {
+			add_box(geometry->mesh_vertices + 4 * (geometry->lod_first_face + 2 * c), cubes, MAZE_CUBE_FLOOR, tiles, 0,
+				center_x, center_y, FACE_TOP | FACE_BOTTOM, 1.0f / MAZE_MESH_LOD_STEPS, no_offset);
+		}
+	}
+
+	// poles and cells never change
+	if (far_quads) {
+		for (int i = 0; i <= height; ++i) {
+			for (int j = 0; j <= width; ++j) { geometry->wall_bits[2 * i * geometry->wall_bits_width + 2 * j] = 255; }
+		}
+	}
+	return true;
+}
+
+// build the chunks of the mesh and the wall bits
+bool maze_geometry_build_mesh(maze_geometry* geometry, const maze_grid* grid) {
+	vec4 cubes[MAZE_CUBE_KINDS][36];
+	build_cubes(cubes);
+
+	// the floor and poles never change, so they are only built along with the chunks
+	if (geometry->mesh_vertices == NULL && !alloc_mesh(geometry, grid, cubes)) { return false; }
+
+	for (int c = 0; c < geometry->num_chunks; ++c) {
+		build_chunk_walls(geometry, grid, &geometry->chunks[c], cubes);
+	}
+	if (geometry->wall_bits != NULL) { build_wall_bits(geometry, grid); }
+	return true;
+}
+
+// rebuild the walls of the chunk that holds the wall on the given side of a cell, and its wall bit
+int maze_geometry_update_mesh(maze_geometry* geometry, const maze_grid* grid, int row, int col, int direction) {
+	// the east and south walls of a cell are the west and north walls of the next one, apart from the border
+	if (direction == east && col + 1 < grid->width) {
+		++col;
+		direction = west;
+	} else if (direction == south && row + 1 < grid->height) {
+		++row;
+		direction = north;
+	}
+
+	if (geometry->wall_bits != NULL) {
+		int stride = geometry->wall_bits_width;
+		switch (direction) {
+			case north: geometry->wall_bits[2 * row * stride + 2 * col + 1] = row_wall(grid, row, col) ? 255 : 0; break;
+			case south: geometry->wall_bits[2 * (row + 1) * stride + 2 * col + 1] = row_wall(grid, row + 1, col) ? 255 : 0; break;
+			case west: geometry->wall_bits[(2 * row + 1) * stride + 2 * col] = column_wall(grid, row, col) ? 255 : 0; break;
+			case east: geometry->wall_bits[(2 * row + 1) * stride + 2 * col + 2] = column_wall(grid, row, col + 1) ? 255 : 0; break;
+		}
+	}
+
+	vec4 cubes[MAZE_CUBE_KINDS][36];
+	build_cubes(cubes);
+	int chunk = (row / MAZE_CHUNK_CELLS) * geometry->chunks_across + col / MAZE_CHUNK_CELLS;
+	build_chunk_walls(geometry, grid, &geometry->chunks[chunk], cubes);
+	return chunk;
+}
+
+// build the transform of every line of the solution from a path, the first keep lines keep their animation
+bool maze_geometry_build_lines(maze_geometry* geometry, const maze_grid* grid, const maze_path* path, long long keep) {
+
+	// matrix that matches transforms applied to the maze itself
+	mat4 maze_match_xform = maze_geometry_fit_xform(grid);
+
+	// one line per step of the solved path plus the two lines out of the exit, the lines that are kept
+	// also keep how far they have been drawn
+	mat4* line_tranforms = calloc(path->length + 2, sizeof(mat4));
+	mat4* anim_tranforms = calloc(path->length + 2, sizeof(mat4));
+	if (line_tranforms == NULL || anim_tranforms == NULL) {
+		free(line_tranforms);
+		free(anim_tranforms);
+		return false;
+	}
+	if (geometry->anim_tranforms != NULL) {
+		memcpy(anim_tranforms, geometry->anim_tranforms, keep * sizeof(mat4));
+	}
+	free(geometry->line_tranforms);
+	free(geometry->anim_tranforms);
+	geometry->line_tranforms = line_tranforms;
+	geometry->anim_tranforms = anim_tranforms;
+
+	// no lines at all while the exit can't be reached
+	if (path->length == 0) {
+		geometry->num_lines = 0;
+		return true;
+	}
+
+	float line_rot = 0.0f;
+
+	int i = 0;
+	// initialize all line transforms to proper values
+	for (   ; i < path->length - 1; ++i) {
+		const maze_step* step = &path->steps[i];
+
+		switch (step->orientation) {
+			case north:
+				line_rot = 0.0f; break;
+			case south:
+				line_rot = 3.14159f; break;
+			case east:
+				line_rot = -3.14159f/2.0f; break;
+			case west:
+				line_rot = 3.14159f/2.0f; break;
+		}
+
+		line_tranforms[i] = mat_mult(
+					maze_match_xform,
+					mat_mult(
+						xform_trans_mat((float)step->row + 1, (float)step->col + 1, 0.0f),
+						xform_rot_mat('z', line_rot)
+						)
+					    );
+	}
+
+	// Add final two lines to maze exit
+	float exit_row = (float)grid->height;
+	float exit_col = (float)grid->width;
+	if (path->steps[i].orientation == south) {
+		line_tranforms[i] = mat_mult(maze_match_xform, mat_mult(xform_trans_mat(exit_row, exit_col, 0.0f), xform_rot_mat('z', 3.14159f)));
+	} else {
+		line_tranforms[i] = mat_mult(maze_match_xform, mat_mult(xform_trans_mat(exit_row, exit_col, 0.0f), xform_rot_mat('z', -3.14159f/2.0f)));
+	}
+	i += 1;
+	line_tranforms[i] = mat_mult(maze_match_xform, mat_mult(xform_trans_mat(exit_row + 1, exit_col, 0.0f), xform_rot_mat('z', 3.14159f)));
+	geometry->num_lines = i + 1;
+	return true;
+}
+
+// MAZE_GEOMETRY_* for a name such as "mesh", -1 when there is no such mode
+int maze_geometry_mode_from_name(const char* name) {
+	if (strcmp(name, "baked") == 0) { return MAZE_GEOMETRY_BAKED; }
+	if (strcmp(name, "instanced") == 0) { return MAZE_GEOMETRY_INSTANCED; }
+	if (strcmp(name, "mesh") == 0) { return MAZE_GEOMETRY_MESH; }
+	return -1;
+}
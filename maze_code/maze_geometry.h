@@ -0,0 +1,181 @@
+#ifndef _MAZE_GEOMETRY_H_
+#define _MAZE_GEOMETRY_H_
+
+#include "../mylib/linear_alg.h"
+#include "maze_grid.h"
+#include "maze_solve.h"
+
+// +----------------------------------------------------------------------+
+// |                                                                      |
+// |                              GEOMETRY                                |
+// |                                                                      |
+// +----------------------------------------------------------------------+
+
+// the triangles of the floor, poles and walls of a maze and the transforms of the lines of its
+// solution, built on the CPU ready to be uploaded. never touches GL, so any thread can build them
+
+// ways a maze can be drawn. baked copies a whole cube into the vertex array for every floor tile,
+// pole and wall. instanced keeps one unit cube of each kind and draws it once per maze_instance.
+// mesh merges the floor into one slab and every straight run of walls into one box, and only keeps
+// the faces that can ever be seen
+#define MAZE_GEOMETRY_BAKED 0
+#define MAZE_GEOMETRY_INSTANCED 1
+#define MAZE_GEOMETRY_MESH 2
+
+// kinds of unit cube, in the order they are stored in cube_vertices
+#define MAZE_CUBE_FLOOR 0
+#define MAZE_CUBE_POLE 1
+#define MAZE_CUBE_WALL 2
+#define MAZE_CUBE_LINE 3
+#define MAZE_CUBE_KINDS 4
+
+// +---------------------+
+// |   TYPE DEFINITION   |
+// +---------------------+
+
+// where one copy of a unit cube goes, in maze units before the maze is fit to the screen: the center
+// of the cube on the floor and how many quarter turns it is turned about z
+typedef struct {
+	float x;
+	float y;
+	float turns;
+} maze_instance;
+
+// mesh positions are whole steps of 1 / MAZE_MESH_STEPS maze units from the offset of their chunk, which
+// every corner of the floor, the poles, the walls and the line cube lands on exactly. the flat quads
+// that stand in for chunks far away only need steps of 1 / MAZE_MESH_LOD_STEPS from the maze origin
+#define MAZE_MESH_STEPS 40
+#define MAZE_MESH_LOD_STEPS 2
+// the mesh is cut into chunks of this many cells square, each drawn and culled on its own
+#define MAZE_CHUNK_CELLS 32
+// the kind of cube of a face is kept in u as kind * MAZE_MESH_KIND_TILES + tiles, a chunk never
+// stretches a face over more tiles than this
+#define MAZE_MESH_KIND_TILES 64
+// the wall bits are one byte per pole, wall and cell, so mazes bigger than this across have no far quads
+#define MAZE_WALL_BITS_MAX 16384
+
+// one corner of a face of the mesh, 8 bytes. the position counts steps from the offset of the chunk
+// and the shader decodes it into maze units before the maze is fit to the screen. texture coordinates
+// count whole tiles, and the shader repeats the part of the texture that belongs to the kind of cube
+// across them
+typedef struct {
+	short x;
+	short y;
+	short z;
+	unsigned char u;
+	unsigned char v;
+} maze_mesh_vertex;
+
+// one square of cells of the mesh with its own floor piece, poles and walls
+typedef struct {
+	// the cells the chunk covers, it also holds the border walls and poles when it is on the south or east edge
+	int row;
+	int col;
+	int rows;
+	int cols;
+	// everything in the chunk is inside this box, in maze units before the maze is fit to the screen
+	float min[3];
+	float max[3];
+	// the positions of the chunk count steps from here
+	float offset[3];
+	// the floor piece and the poles come first and never change, then the runs of walls, with room
+	// for the most runs the chunk can have
+	int first_face;
+	int fixed_faces;
+	int wall_faces;
+	int max_wall_faces;
+} maze_chunk;
+
+typedef struct {
+	// vertex counts of each section of the vertex array, sized from the maze dimensions
+	int num_floor_verts;
+	int num_pole_verts;
+	int num_wall_verts;
+	int maze_verts;
+
+	// large enough to hold verts if every side of each cell contained a wall, followed by the
+	// 36 verts of one line cube. walls that are down leave zeroed verts at the end of the wall section
+	vec4* vertices;
+	float (*tex_coords)[2];
+
+	// one unit cube of each MAZE_CUBE_* kind and its texture coordinates, followed by the instances of
+	// every floor tile, then every pole, then every wall that is up. only the walls change with edits
+	vec4 cube_vertices[MAZE_CUBE_KINDS * 36];
+	float cube_tex_coords[MAZE_CUBE_KINDS * 36][2];
+	maze_instance* instances;
+	int first_instance[MAZE_CUBE_KINDS];
+	int num_instances[MAZE_CUBE_KINDS];
+	// room for the floor, the poles and every wall of a maze with every wall up
+	int max_instances;
+
+	// the mesh: the line cube, then two faces per chunk for the flat quad that stands in for it from far
+	// away, then every chunk. every face has 4 verts of its own and 6 indices, the indices only depend on
+	// how many faces come before so they are built once for every face there is room for
+	maze_mesh_vertex* mesh_vertices;
+	// unsigned shorts while 16 bits can reach every vert, unsigned ints after that
+	void* mesh_indices;
+	int mesh_index_size;
+	int mesh_capacity;
+	maze_chunk* chunks;
+	int chunks_down;
+	int chunks_across;
+	int num_chunks;
+	int lod_first_face;
+
+	// one byte per pole, wall and cell, 255 where it is solid and 0 on the floor, (2 * height + 1) rows of
+	// (2 * width + 1) padded with floor up to powers of two. the far quads are colored from it. NULL when
+	// the maze is too big
+	unsigned char* wall_bits;
+	int wall_bits_width;
+	int wall_bits_height;
+
+	// one transform per line of the solution, and how far along its animation each line is
+	mat4* line_tranforms;
+	mat4* anim_tranforms;
+	int num_lines;
+
+	// arena the vertices, texture coordinates and instances came from, NULL when they are on the heap.
+	// the line transforms change size with the path and are always on the heap
+	maze_arena* arena;
+} maze_geometry;
+
+// +---------------+
+// |   FUNCTIONS   |
+// +---------------+
+
+// set up empty geometry, nothing is allocated until it is built
+void maze_geometry_init(maze_geometry* geometry);
+// set up empty geometry whose vertices and texture coordinates will come out of an arena
+void maze_geometry_init_arena(maze_geometry* geometry, maze_arena* arena);
+// release the memory held by the geometry
+void maze_geometry_free(maze_geometry* geometry);
+
+// transform that centers the maze on screen, scales it to fit and rotates it to make north up
+mat4 maze_geometry_fit_xform(const maze_grid* grid);
+
+// build the vertices of every wall that is up. the arrays are allocated on the first call and reused
+// after that, so the grid must keep its dimensions. returns false when out of memory or when the maze
+// has more verts than GL can draw in one call
+bool maze_geometry_build(maze_geometry* geometry, const maze_grid* grid);
+
+// build the unit cubes and an instance of every floor tile, pole and wall that is up. the instances are
+// allocated on the first call and reused after that, so the grid must keep its dimensions.
+// returns false when out of memory or when the maze has more instances than GL can draw in one call
+bool maze_geometry_build_instances(maze_geometry* geometry, const maze_grid* grid);
+
+// build the chunks of the mesh with their floor, poles and merged walls, and the wall bits. the arrays are
+// allocated on the first call and reused after that, so the grid must keep its dimensions. returns false
+// when out of memory
+bool maze_geometry_build_mesh(maze_geometry* geometry, const maze_grid* grid);
+// after the wall on the given side of a cell was opened or closed, rebuild the walls of the chunk that holds
+// it and its wall bit. returns the index of the chunk
+int maze_geometry_update_mesh(maze_geometry* geometry, const maze_grid* grid, int row, int col, int direction);
+
+// build the transform of every line of the solution from a path, the first keep lines must be the same
+// in the old and new path and keep their animation, the rest start out undrawn. returns false when out of memory
+bool maze_geometry_build_lines(maze_geometry* geometry, const maze_grid* grid, const maze_path* path, long long keep);
+
+// MAZE_GEOMETRY_* for a name such as "mesh", -1 when there is no such mode
+int maze_geometry_mode_from_name(const char* name);
+
+#endif
@@ -0,0 +1,197 @@
+#ifndef _MAZE_GRID_H_
+#define _MAZE_GRID_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "maze_arena.h"
+
+// stuff to make working with booleans easier
+typedef int bool;
+#define true 1
+#define false 0
+
+// defines to make code read more cleanly
+// also used when solving the maze and determining direction
+#define north 1
+#define east 2
+#define south 3
+#define west 4
+
+// storage order of the cells inside each bitset
+#define MAZE_LAYOUT_ROW_MAJOR 0
+#define MAZE_LAYOUT_MORTON 1
+
+// morton grids are cut into square tiles of 256x256 cells laid out row major, the cells of each
+// tile are stored in Z order so every word holds an 8x8 block and neighbors above and below
+// are usually in the same word or cache line
+#define MAZE_MORTON_TILE_BITS 8
+
+// +----------------------------------------------------------------------+
+// |                                                                      |
+// |                              GRID                                    |
+// |                                                                      |
+// +----------------------------------------------------------------------+
+
+// +---------------------+
+// |   TYPE DEFINITION   |
+// +---------------------+
+
+// packed maze grid, each cell only stores its south and east wall as one bit in
+// two separate bitsets, the north and west walls are read from the neighboring cell.
+// in row major grids every row of a bitset is padded out to a whole number of 64 bit words.
+typedef struct {
+	int width;
+	int height;
+	int layout;
+
+	// words in one row major row, which is also the size of the rows handed out by maze_grid_get_row
+	size_t words_per_row;
+	// morton tiles in one row of tiles
+	size_t tiles_across;
+
+	uint64_t* south_walls;
+	uint64_t* east_walls;
+
+	// bitset that determines whether each cell has been visited during creation of maze
+	uint64_t* visited;
+
+	// column of the opening in the north border, -1 when there is none
+	int entrance_col;
+
+	// arena the bitsets came from, NULL when they are on the heap
+	maze_arena* arena;
+} maze_grid;
+
+// +---------------+
+// |   FUNCTIONS   |
+// +---------------+
+
+// allocate a row major grid with every wall up and every cell unvisited, returns false when out of memory
+bool maze_grid_init(maze_grid* grid, int width, int height);
+// allocate a grid with the given MAZE_LAYOUT_* cell order
+bool maze_grid_init_layout(maze_grid* grid, int width, int height, int layout);
+// allocate a grid out of an arena, or off the heap when arena is NULL
+bool maze_grid_init_arena(maze_grid* grid, int width, int height, int layout, maze_arena* arena);
+// release the memory held by a grid
+void maze_grid_free(maze_grid* grid);
+
+// put every wall back up and mark every cell as unvisited
+void maze_grid_reset(maze_grid* grid);
+// mark every cell as unvisited
+void maze_grid_clear_visited(maze_grid* grid);
+
+// size of one bitset in bytes
+size_t maze_grid_bitset_size(const maze_grid* grid);
+
+// MAZE_LAYOUT_* for a name such as "morton", -1 when there is no such layout
+int maze_layout_from_name(const char* name);
+
+// copy the south and east walls of one row out of the grid as row major words, whatever the layout
+void maze_grid_get_row(const maze_grid* grid, int row, uint64_t* south_walls, uint64_t* east_walls);
+// overwrite the south and east walls of one row from row major words, whatever the layout
+void maze_grid_set_row(maze_grid* grid, int row, const uint64_t* south_walls, const uint64_t* east_walls);
+
+// +--------------------+
+// |   CELL ACCESSORS   |
+// +--------------------+
+
+// the low 8 bits of a row or column spread out to the even bits
+extern const uint16_t maze_spread_table[256];
+
+// bit position of a cell inside each bitset
+static inline size_t maze_bit(const maze_grid* grid, int row, int col) {
+	if (grid->layout == MAZE_LAYOUT_MORTON) {
+		size_t tile = (size_t)(row >> MAZE_MORTON_TILE_BITS) * grid->tiles_across + (col >> MAZE_MORTON_TILE_BITS);
+		return (tile << (2 * MAZE_MORTON_TILE_BITS)) | (maze_spread_table[row & 0xff] << 1) | maze_spread_table[col & 0xff];
+	}
+	return (size_t)row * grid->words_per_row * 64 + col;
+}
+
+static inline bool maze_test_bit(const uint64_t* bits, size_t bit) {
+	return (bits[bit >> 6] >> (bit & 63)) & 1;
+}
+
+static inline void maze_set_bit(uint64_t* bits, size_t bit) {
+	bits[bit >> 6] |= (uint64_t)1 << (bit & 63);
+}
+
+static inline void maze_clear_bit(uint64_t* bits, size_t bit) {
+	bits[bit >> 6] &= ~((uint64_t)1 << (bit & 63));
+}
+
+// whether the given side of a cell has a wall, the outer border always has a wall
+// apart from the entrance in the north border and any opening in the south border
+static inline bool maze_has_wall(const maze_grid* grid, int row, int col, int direction) {
+	switch (direction) {
+		case north:
+			if (row == 0) { return col != grid->entrance_col; }
+			return maze_test_bit(grid->south_walls, maze_bit(grid, row - 1, col));
+		case south:
+			return maze_test_bit(grid->south_walls, maze_bit(grid, row, col));
+		case east:
+			return maze_test_bit(grid->east_walls, maze_bit(grid, row, col));
+		case west:
+			if (col == 0) { return true; }
+			return maze_test_bit(grid->east_walls, maze_bit(grid, row, col - 1));
+	}
+	return true;
+}
+
+// knock down the wall on the given side of a cell, which is also the wall of its neighbor
+static inline void maze_remove_wall(maze_grid* grid, int row, int col, int direction) {
+	switch (direction) {
+		case north:
+			if (row == 0) { grid->entrance_col = col; }
+			else { maze_clear_bit(grid->south_walls, maze_bit(grid, row - 1, col)); }
+			break;
+		case south:
+			maze_clear_bit(grid->south_walls, maze_bit(grid, row, col)); break;
+		case east:
+			maze_clear_bit(grid->east_walls, maze_bit(grid, row, col)); break;
+		case west:
+			if (col > 0) { maze_clear_bit(grid->east_walls, maze_bit(grid, row, col - 1)); }
+			break;
+	}
+}
+
+// put back up the wall on the given side of a cell, the opposite of maze_remove_wall
+static inline void maze_add_wall(maze_grid* grid, int row, int col, int direction) {
+	switch (direction) {
+		case north:
+			if (row == 0) { if (col == grid->entrance_col) { grid->entrance_col = -1; } }
+			else { maze_set_bit(grid->south_walls, maze_bit(grid, row - 1, col)); }
+			break;
+		case south:
+			maze_set_bit(grid->south_walls, maze_bit(grid, row, col)); break;
+		case east:
+			maze_set_bit(grid->east_walls, maze_bit(grid, row, col)); break;
+		case west:
+			if (col > 0) { maze_set_bit(grid->east_walls, maze_bit(grid, row, col - 1)); }
+			break;
+	}
+}
+
+// whether it is possible to step from a cell to its neighbor in the given direction without leaving the maze
+static inline bool maze_can_move(const maze_grid* grid, int row, int col, int direction) {
+	switch (direction) {
+		case north:
+			if (row == 0) { return false; } break;
+		case south:
+			if (row == grid->height - 1) { return false; } break;
+		case east:
+			if (col == grid->width - 1) { return false; } break;
+		case west:
+			if (col == 0) { return false; } break;
+	}
+	return !maze_has_wall(grid, row, col, direction);
+}
+
+static inline bool maze_visited(const maze_grid* grid, int row, int col) {
+	return maze_test_bit(grid->visited, maze_bit(grid, row, col));
+}
+
+static inline void maze_set_visited(maze_grid* grid, int row, int col) {
+	maze_set_bit(grid->visited, maze_bit(grid, row, col));
+}
+
+#endif
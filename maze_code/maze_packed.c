@@ -0,0 +1,244 @@
+#include <stdlib.h>
+#include <string.h>
+#include "maze_packed.h"
+#include "maze_file.h"
+
+// letter of each direction for writing out runs
+static const char direction_letters[] = " NESW";
+
+// header at the start of a packed path file
+typedef struct {
+	char magic[8];
+	uint32_t version;
+	// written as MAZE_FILE_BYTE_ORDER in the byte order of the machine that saved the file
+	uint32_t byte_order;
+	int32_t start_row;
+	int32_t start_col;
+} packed_header;
+
+// +---------------+
+// |   FUNCTIONS   |
+// +---------------+
+
+// set up an empty packed path that owns no memory yet
+void maze_packed_init(maze_packed_path* packed) {
+	packed->start_row = -1;
+	packed->start_col = -1;
+	packed->moves = 0;
+	packed->words = NULL;
+	packed->capacity = 0;
+}
+
+// release the memory held by a packed path
+void maze_packed_free(maze_packed_path* packed) {
+	free(packed->words);
+	maze_packed_init(packed);
+}
+
+// make room for at least the given number of words, returns false when out of memory
+static bool reserve_words(maze_packed_path* packed, long long words) {
+	if (words <= packed->capacity) { return true; }
+
+	long long capacity = (packed->capacity == 0) ? 64 : packed->capacity;
+	while (capacity < words) { capacity *= 2; }
+	uint64_t* grown = realloc(packed->words, capacity * sizeof(uint64_t));
+	if (grown == NULL) { return false; }
+	packed->words = grown;
+	packed->capacity = capacity;
+	return true;
+}
+
+// add one move in the given direction to the end, returns false when out of memory
+bool maze_packed_push(maze_packed_path* packed, int direction) {
+	long long word = packed->moves >> 5;
+	if (!reserve_words(packed, word + 1)) { return false; }
+	if ((packed->moves & 31) == 0) { packed->words[word] = 0; }
+	packed->words[word] |= (uint64_t)(direction - 1) << (2 * (packed->moves & 31));
+	++packed->moves;
+	return true;
+}
+
+// pack a path, the orientation of its first step isn't a move and is dropped
+bool maze_packed_from_path(maze_packed_path* packed, const maze_path* path) {
+	packed->moves = 0;
+	if (path->length == 0) {
+		packed->start_row = -1;
+		packed->start_col = -1;
+		return true;
+	}
+
+	packed->start_row = path->steps[0].row;
+	packed->start_col = path->steps[0].col;
+	if (!reserve_words(packed, (path->length - 1 + 31) / 32)) { return false; }
+
+	// fill whole words at a time instead of going through maze_packed_push
+	long long moves = path->length - 1;
+	for (long long word = 0; word * 32 < moves; ++word) {
+		uint64_t bits = 0;
+		long long end = (word * 32 + 32 < moves) ? 32 : moves - word * 32;
+		for (long long i = 0; i < end; ++i) {
+			bits |= (uint64_t)(path->steps[word * 32 + i + 1].orientation - 1) << (2 * i);
+		}
+		packed->words[word] = bits;
+	}
+	packed->moves = moves;
+	return true;
+}
+
+// unpack into a path with the first step marked as entered heading south
+bool maze_packed_to_path(const maze_packed_path* packed, maze_path* path) {
+	if (packed->start_row < 0) {
+		path->length = 0;
+		return true;
+	}
+	if (!maze_path_reserve(path, packed->moves + 1)) { return false; }
+
+	maze_move_iter iter;
+	maze_move_iter_init(&iter, packed);
+	path->steps[0].row = iter.row;
+	path->steps[0].col = iter.col;
+	path->steps[0].orientation = south;
+	int direction;
+	for (long long i = 1; maze_move_iter_next(&iter, &direction); ++i) {
+		path->steps[i].row = iter.row;
+		path->steps[i].col = iter.col;
+		path->steps[i].orientation = direction;
+	}
+	path->length = packed->moves + 1;
+	return true;
+}
+
+// start walking a packed path from its first cell
+void maze_move_iter_init(maze_move_iter* iter, const maze_packed_path* packed) {
+	iter->path = packed;
+	iter->next = 0;
+	iter->row = packed->start_row;
+	iter->col = packed->start_col;
+}
+
+// take the next move, returns false at the end of the path
+bool maze_move_iter_next(maze_move_iter* iter, int* direction) {
+	if (iter->next >= iter->path->moves) { return false; }
+	*direction = maze_packed_move(iter->path, iter->next++);
+	iter->row += (*direction == south) - (*direction == north);
+	iter->col += (*direction == east) - (*direction == west);
+	return true;
+}
+
+// take every move up to the next turn at once, a whole word at a time
+bool maze_move_iter_next_run(maze_move_iter* iter, int* direction, long long* length) {
+	const maze_packed_path* packed = iter->path;
+	if (iter->next >= packed->moves) { return false; }
+
+	// xor with the direction copied into every 2 bit field leaves zero fields for as long as the run lasts
+	long long first = iter->next;
+	*direction = maze_packed_move(packed, first);
+	uint64_t same = 0x5555555555555555ULL * (uint64_t)(*direction - 1);
+	long long i = first;
+	while (i < packed->moves) {
+		uint64_t differ = (packed->words[i >> 5] ^ same) >> (2 * (i & 31));
+		if (differ != 0) {
+			i += __builtin_ctzll(differ) / 2;
+			break;
+		}
+		i += 32 - (i & 31);
+	}
+
+	// the unused fields of the last word read as north, so a run going north can overshoot the end
+	if (i > packed->moves) { i = packed->moves; }
+	*length = i - first;
+	iter->next = i;
+	iter->row += (int)*length * ((*direction == south) - (*direction == north));
+	iter->col += (int)*length * ((*direction == east) - (*direction == west));
+	return true;
+}
+
+// write the moves as runs such as S3E12N1 after the first cell
+bool maze_packed_write_runs(FILE* out, const maze_packed_path* packed) {
+	fprintf(out, "%i %i ", packed->start_row, packed->start_col);
+
+	maze_move_iter iter;
+	maze_move_iter_init(&iter, packed);
+	int direction;
+	long long length;
+	while (maze_move_iter_next_run(&iter, &direction, &length)) {
+		fprintf(out, "%c%lli", direction_letters[direction], length);
+	}
+	fputc('\n', out);
+	return !ferror(out);
+}
+
+// start a packed path file
+bool maze_packed_writer_begin(maze_packed_writer* writer, FILE* out, int start_row, int start_col) {
+	packed_header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, MAZE_PACKED_MAGIC, sizeof(MAZE_PACKED_MAGIC));
+	header.version = MAZE_PACKED_VERSION;
+	header.byte_order = MAZE_FILE_BYTE_ORDER;
+	header.start_row = start_row;
+	header.start_col = start_col;
+
+	writer->out = out;
+	writer->word = 0;
+	writer->moves = 0;
+	return fwrite(&header, sizeof(header), 1, out) == 1;
+}
+
+// write one move
+bool maze_packed_writer_put(maze_packed_writer* writer, int direction) {
+	writer->word |= (uint64_t)(direction - 1) << (2 * (writer->moves & 31));
+	if ((++writer->moves & 31) != 0) { return true; }
+
+	bool ok = fwrite(&writer->word, sizeof(uint64_t), 1, writer->out) == 1;
+	writer->word = 0;
+	return ok;
+}
+
+// write the last partial word and the number of moves
+bool maze_packed_writer_end(maze_packed_writer* writer) {
+	if ((writer->moves & 31) != 0 && fwrite(&writer->word, sizeof(uint64_t), 1, writer->out) != 1) { return false; }
+	int64_t moves = writer->moves;
+	return fwrite(&moves, sizeof(moves), 1, writer->out) == 1;
+}
+
+// write a whole packed path file
+bool maze_packed_write(FILE* out, const maze_packed_path* packed) {
+	maze_packed_writer writer;
+	if (!maze_packed_writer_begin(&writer, out, packed->start_row, packed->start_col)) { return false; }
+
+	// whole words go straight out, the writer only sees the last partial one
+	long long whole = packed->moves >> 5;
+	if (whole > 0 && fwrite(packed->words, sizeof(uint64_t), whole, out) != (size_t)whole) { return false; }
+	writer.moves = whole * 32;
+	for (long long i = whole * 32; i < packed->moves; ++i) {
+		if (!maze_packed_writer_put(&writer, maze_packed_move(packed, i))) { return false; }
+	}
+	return maze_packed_writer_end(&writer);
+}
+
+// read a packed path file to its end
+bool maze_packed_read(FILE* in, maze_packed_path* packed) {
+	packed_header header;
+	if (fread(&header, sizeof(header), 1, in) != 1
+			|| memcmp(header.magic, MAZE_PACKED_MAGIC, sizeof(MAZE_PACKED_MAGIC)) != 0
+			|| header.version != MAZE_PACKED_VERSION || header.byte_order != MAZE_FILE_BYTE_ORDER) {
+		return false;
+	}
+
+	// the length is only known at the end, so read every word and take the last one as the move count
+	long long words = 0;
+	while (true) {
+		if (!reserve_words(packed, words + 1024)) { return false; }
+		size_t got = fread(packed->words + words, sizeof(uint64_t), 1024, in);
+		words += got;
+		if (got < 1024) { break; }
+	}
+	if (ferror(in) || words < 1) { return false; }
+
+	long long moves = (long long)packed->words[words - 1];
+	if (moves < 0 || (moves + 31) / 32 != words - 1) { return false; }
+	packed->start_row = header.start_row;
+	packed->start_col = header.start_col;
+	packed->moves = moves;
+	return true;
+}
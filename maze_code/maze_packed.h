@@ -0,0 +1,97 @@
+#ifndef _MAZE_PACKED_H_
+#define _MAZE_PACKED_H_
+
+#include <stdio.h>
+#include "maze_grid.h"
+#include "maze_solve.h"
+
+// +----------------------------------------------------------------------+
+// |                                                                      |
+// |                           PACKED PATHS                               |
+// |                                                                      |
+// +----------------------------------------------------------------------+
+
+// a path stored as its first cell and 2 bits per move, 32 moves to a word, so a million step path
+// is 250 KB instead of the 12 MB of a maze_path. move i is bits 2i and 2i + 1 of the words and
+// holds its direction minus one
+
+// packed path files are a small header, the words, and then the number of moves, so they can be
+// written to a pipe one move at a time without knowing the length up front
+#define MAZE_PACKED_MAGIC "MAZEPTH"
+#define MAZE_PACKED_VERSION 1
+
+// +---------------------+
+// |   TYPE DEFINITION   |
+// +---------------------+
+
+typedef struct {
+	// first cell, -1 for a path with no cells at all
+	int start_row;
+	int start_col;
+
+	long long moves;
+	uint64_t* words;
+	long long capacity;
+} maze_packed_path;
+
+// walks the moves of a packed path one at a time or one straight run at a time
+typedef struct {
+	const maze_packed_path* path;
+	long long next;
+	// cell reached after the moves taken so far
+	int row;
+	int col;
+} maze_move_iter;
+
+// writes a packed path file one move at a time
+typedef struct {
+	FILE* out;
+	uint64_t word;
+	long long moves;
+} maze_packed_writer;
+
+// +---------------+
+// |   FUNCTIONS   |
+// +---------------+
+
+// set up an empty packed path that owns no memory yet
+void maze_packed_init(maze_packed_path* packed);
+// release the memory held by a packed path
+void maze_packed_free(maze_packed_path* packed);
+
+// add one move in the given direction to the end, returns false when out of memory
+bool maze_packed_push(maze_packed_path* packed, int direction);
+
+// pack a path, the orientation of its first step isn't a move and is dropped. returns false when out of memory
+bool maze_packed_from_path(maze_packed_path* packed, const maze_path* path);
+// unpack into a path with the first step marked as entered heading south. returns false when out of memory
+bool maze_packed_to_path(const maze_packed_path* packed, maze_path* path);
+
+// direction of move i
+static inline int maze_packed_move(const maze_packed_path* packed, long long i) {
+	return ((packed->words[i >> 5] >> (2 * (i & 31))) & 3) + 1;
+}
+
+// start walking a packed path from its first cell
+void maze_move_iter_init(maze_move_iter* iter, const maze_packed_path* packed);
+// take the next move, returns false at the end of the path
+bool maze_move_iter_next(maze_move_iter* iter, int* direction);
+// take every move up to the next turn at once, a whole word at a time. returns false at the end of the path
+bool maze_move_iter_next_run(maze_move_iter* iter, int* direction, long long* length);
+
+// write the moves as runs such as S3E12N1 after the first cell, returns false on any write error
+bool maze_packed_write_runs(FILE* out, const maze_packed_path* packed);
+
+// start a packed path file, returns false on any write error
+bool maze_packed_writer_begin(maze_packed_writer* writer, FILE* out, int start_row, int start_col);
+// write one move, returns false on any write error
+bool maze_packed_writer_put(maze_packed_writer* writer, int direction);
+// write the last partial word and the number of moves, returns false on any write error
+bool maze_packed_writer_end(maze_packed_writer* writer);
+
+// write a whole packed path file, returns false on any write error
+bool maze_packed_write(FILE* out, const maze_packed_path* packed);
+// read a packed path file to its end, returns false when out of memory or when it isn't a packed path file
+bool maze_packed_read(FILE* in, maze_packed_path* packed);
+
+#endif
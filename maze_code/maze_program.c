@@ -10,10 +10,15 @@
 #include <GL/freeglut_ext.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
+#include <unistd.h>
 
 #include "../mylib/initShader.h"
 #include "../mylib/linear_alg.h"
+#include "maze_context.h"
+#include "maze_gen.h"
+#include "maze_batch.h"
 
 
 #define BUFFER_OFFSET( offset )   ((GLvoid*) (offset))
@@ -24,288 +29,14 @@
 // ----------------------------------------------------------------------------------
 // ----------------------------------------------------------------------------------
 
-// stuff to make working with booleans easier
-typedef int bool;
-#define true 1
-#define false 0
-
-// main struct that makes up the maze
-typedef struct {
-	// bools that tell whether each cell has a wall or not
-	bool north_has_wall;
-	bool south_has_wall;
-	bool east_has_wall;
-	bool west_has_wall;
-
-	// bool that determines whether each cell has been visited during creation of maze
-	bool visited;
-	
-} cell;
-
-// 2d array that contains the maze itself
-cell maze[8][8];
-
-// maze printing function for debugging and display
-void print_maze() {
-	for (int i = 0; i < 8; ++i) {
-		// first row
-		for (int j = 0; j < 8; ++j) {
-			printf("+");
-			if (maze[i][j].north_has_wall) {
-				printf("+++");
-			} else {
-				printf("   ");
-			}
-			printf("+");
-		}
-		printf("\n");
-		// second row
-		for (int j = 0; j < 8; ++j) {
-			if (maze[i][j].west_has_wall) {
-				printf("|");
-			} else {
-				printf(" ");
-			}
-			printf("   ");
-			if (maze[i][j].east_has_wall) {
-				printf("|");
-			} else {
-				printf(" ");
-			}
-		}
-		printf("\n");
-		// first row
-		for (int j = 0; j < 8; ++j) {
-			printf("+");
-			if (maze[i][j].south_has_wall) {
-				printf("+++");
-			} else {
-				printf("   ");
-			}
-			printf("+");
-		}
-		printf("\n");
-	}
-}
-
-// set every cell up for maze generation
-void initialize_maze() {
-	// Set each cell to have walls on each side and mark as unvisited
-	for (int i = 0; i < 8; ++i) {
-		for (int j = 0; j < 8; ++j) {
-			maze[i][j].north_has_wall = true;
-			maze[i][j].south_has_wall = true;
-			maze[i][j].east_has_wall = true;
-			maze[i][j].west_has_wall = true;
-			maze[i][j].visited = false;
-		}
-	}
-}
-
-// defines to make code read more cleanly
-// also used when solving the maze and determining direction
-#define north 1
-#define east 2
-#define south 3
-#define west 4
-
-// recursive maze generation code
-void generate_maze(int row, int col, int incoming_direction) {
-
-	// mark this cell as visited
-	maze[row][col].visited = true;
-
-	// remove wall of this cell from direction where it came from
-	switch (incoming_direction) {
-		case north:
-			maze[row][col].south_has_wall = false; break;
-		case south:
-			maze[row][col].north_has_wall = false; break;
-		case east:
-			maze[row][col].west_has_wall =  false; break;
-		case west:
-			maze[row][col].east_has_wall =  false; break;
-	}
-
-	// bools used for reading clarity
-	bool north_visited;
-	bool south_visited;
-	bool east_visited;
-	bool west_visited;
-	
-	// loop that is exited when all sides are marked as visited
-	while (true) {
-		// determine whether neighboring cells are valid movement spots,
-		// including checking for hitting the edge of the maze
-		south_visited = (row == 7) ? true : maze[row+1][col].visited;
-		north_visited = (row == 0) ? true : maze[row-1][col].visited;
-		east_visited  = (col == 7) ? true : maze[row][col+1].visited;
-		west_visited  = (col == 0) ? true : maze[row][col-1].visited;
-
-		// when all sides relative to cell are visited, go back one in the recursive chain
-		if (north_visited && south_visited && east_visited && west_visited) { return; }
-
-		// use random number generator to determine which direction to go
-		// 1 = north, 2 = south, 3 = east, 4 = west
-		int direction = (rand() % 4) + 1;
-
-		// determine which cell to go to and update information for this cell and function call
-		if (direction == north && !north_visited) {
-			maze[row][col].north_has_wall = false;
-			north_visited = true;
-			generate_maze(row-1, col, north);
-		} else if (direction == south && !south_visited) {
-			maze[row][col].south_has_wall = false;
-			south_visited = true;
-			generate_maze(row+1, col, south);
-		} else if (direction == east && !east_visited) {
-			maze[row][col].east_has_wall = false;
-			east_visited = true;
-			generate_maze(row, col+1, east);
-		} else if (direction == west && !west_visited) {
-			maze[row][col].west_has_wall = false;
-			west_visited = true;
-			generate_maze(row, col-1, west);
-		}
-	}
-}
-
-// helper function to kick off recursive maze generation
-void start_maze_generation() {
-	srand(time(0)); // randomize seed
-	initialize_maze();
-	generate_maze(0, 0, south); // starting point for recursion
-	maze[7][7].south_has_wall = false; // add exit point at bottom right of maze when program is done running
-}
+// the maze on screen with its settings, solution and geometry. GLUT callbacks take no user data,
+// so the viewer keeps its one context here while the library itself has no globals
+maze_context context;
 
 // switch between solid color and texture sampling, needed for blue line
 int use_texture;
 GLuint use_texture_location;
 
-// ------------------------------------
-// ----------- MAZE SOLVING -----------
-// ------------------------------------
-
-// doubly linked list used to keep track of movements for backtracking and
-// easy removal of duplicate steps for finding shortest path
-struct node {
-	struct node* next;
-	struct node* prev;
-	int row;
-	int col;
-	int orientation;
-};
-
-struct node* head;
-
-void solve_maze() {
-	
-	// starting data for entrance at the north west corner of maze going down
-	int row = 0;
-	int col = 0;
-	int orientation = south;
-
-	// define head of linked list
-	head = malloc(sizeof(struct node));
-	head->next = NULL;
-	head->prev = NULL;
-	head->row = row;
-	head->col = col;
-	head->orientation = orientation; // IMPORTANT: Notates the orientation of the camera as it enters the cell
-
-	// reference to most recent node
-	struct node* current_node = head;
-
-	// generate raw list of directions to exit of maze
-	while (row != 7 || col != 7) {
-
-		// set orientation to look left relative to current position
-		orientation = (orientation + 6) % 4 + 1;
-
-		// find next valid position, starting with previously mentioned left turn then turning right repeatedly
-		while (true) {
-			if (orientation == north) {
-				if (maze[row][col].north_has_wall) { orientation = orientation % 4 + 1; }
-				else { row -= 1; break; }
-			}
-			else if (orientation == east) {
-				if (maze[row][col].east_has_wall) { orientation = orientation % 4 + 1; }
-				else { col += 1; break; }
-			}
-			else if (orientation == south) {
-				if (maze[row][col].south_has_wall) { orientation = orientation % 4 + 1; }
-				else { row += 1; break; }
-			}
-			else if (orientation == west) {
-				if (maze[row][col].west_has_wall) { orientation = orientation % 4 + 1; }
-				else { col -= 1; break; }
-			}
-		}
-
-		// add node to linked list
-		struct node* new_node = malloc(sizeof(struct node));
-		current_node->next = new_node;
-		new_node->next = NULL;
-		new_node->prev = current_node;
-		new_node->row = row;
-		new_node->col = col;
-		new_node->orientation = orientation;
-
-		// update current node to prepare for next loop
-		current_node = current_node->next;
-	}
-
-	// clean up list of directions for shortest path
-	struct node* left_node = head;
-
-	while (left_node != NULL) {
-		// reset position of right node for next loop
-		struct node* right_node = left_node->next;
-		while (right_node != NULL) {
-			if (left_node->row == right_node->row && left_node->col == right_node->col) {
-				// get rid of nodes between left and right node, leaving the right node in the list but not the left
-
-				// store reference to left node for memory freeing purposes
-				struct node* temp1 = left_node;
-				struct node* temp2 = left_node;
-
-				// update trail of nodes by skipping first instance of cell and pointing to second instance
-				left_node->prev->next = right_node;
-				// update right node's prev pointer to point to the node before left_node
-				right_node->prev = left_node->prev;
-				right_node->orientation = left_node->orientation;
-				// set left node to right node to prepare for next iterations of loop
-				left_node = right_node;
-
-				// free the memory on the heap taken up by items in the list we no longer need
-				while (temp1 != right_node) {
-					temp2 = temp1->next;
-					free(temp1);
-					temp1 = temp2;
-				}
-			}
-			right_node = right_node->next;
-		}
-		left_node = left_node->next;
-	}
-
-	/*
-	int x = 0;
-	printf("\n\nSHORTEST PATH:\n");
-	struct node* temp = head;
-	while (temp != NULL) {
-		printf("Row: %i, Col: %i\n", temp->row, temp->col);
-		temp = temp->next;
-		x += 1;
-	}
-	printf("Shortest path found! %i moves.\n", x);
-
-	*/
-}
-
-
-
-
 GLuint model_view_matrix_location;
 mat4 model_view_matrix = {
 { 1.0f, 0.0f, 0.0f, 0.0f },
@@ -320,216 +51,12 @@ mat4 og_view_matrix = {
 { 0.0f, 0.0f, 0.0f, 1.0f }};
 
 
-mat4 line_tranforms[66];
-
 // ----------------------------------------------------------------------------------
 // ----------------------------------------------------------------------------------
 // ------------------------------- MAZE BASE CODE END -------------------------------
 // ----------------------------------------------------------------------------------
 // ----------------------------------------------------------------------------------
 
-// main array of vertices, large enough to hold verts if every side of each cell contained a wall
-#define MAZE_VERTS 11700
-vec4 vertices[MAZE_VERTS + 36];
-
-void create_geometry() {
-
-	// ---------- GENERATE BASE CUBE ----------
-	
-	// create initial square face
-	vec4 base_cube[36] = {
-	{ -0.5f,  0.5f, 0.5f, 1.0f }, // top left
-	{ -0.5f, -0.5f, 0.5f, 1.0f }, // bot left
-	{  0.5f, -0.5f, 0.5f, 1.0f }, // bot right
-	{ -0.5f,  0.5f, 0.5f, 1.0f }, // top left
-	{  0.5f, -0.5f, 0.5f, 1.0f }, // bot right
-	{  0.5f,  0.5f, 0.5f, 1.0f }, // top right
-	};
-	
-	// copy and rotate inital cube to form full cube
-	// SIDE COMMENTS ARE RELATIVE TO DEFAULT CAMERA VIEW
-
-	int offset = 6;
-	float pi = 3.14159;
-	mat4 curr_xform = xform_rot_mat('x', pi/2);
-
-	// bottom
-	for (int i = 0; i < 6; ++i) {
-		base_cube[i + offset] = mat_vec_mult(curr_xform, base_cube[i]);
-	}
-	// right
-	offset += 6;
-	curr_xform = xform_rot_mat('z', pi/2);
-	for (int i = 0; i < 6; ++i) {
-		base_cube[i + offset] = mat_vec_mult(curr_xform, base_cube[i + 6]);
-	}
-	// top
-	offset += 6;
-	for (int i = 0; i < 6; ++i) {
-		base_cube[i + offset] = mat_vec_mult(curr_xform, base_cube[i + 12]);
-	}
-	// left
-	offset += 6;
-	for (int i = 0; i < 6; ++i) {
-		base_cube[i + offset] = mat_vec_mult(curr_xform, base_cube[i + 18]);
-	}
-	// back
-	offset += 6;
-	curr_xform = xform_rot_mat('y', -pi/2);
-	for (int i = 0; i < 6; ++i) {
-		base_cube[i + offset] = mat_vec_mult(curr_xform, base_cube[i + 24]);
-	}
-
-	// ------------------------------------------------------------------------
-	// ---------- CUSTOMIZE CUBES FOR WALLS, FLOOR, POLES, AND LINES ----------
-	// ------------------------------------------------------------------------
-
-	// arrays to hold each base cube
-	vec4 floor_cube[36];
-	vec4 pole_cube[36];
-	vec4 wall_cube[36];
-	vec4 line_cube[36];
-	
-	// -------------------- FLOOR --------------------
-	// create floor cube base by translating cube down .5 z units to align top with xy axis
-	curr_xform = xform_trans_mat(0.0f, 0.0f, -0.5f);
-	for (int i = 0; i < 36; ++i) {
-		floor_cube[i] = mat_vec_mult(curr_xform, base_cube[i]);
-	}
-
-	// -------------------- POLE --------------------
-	// create pole cube by moving up so bottom lies on xy axis, then scale down on x and y axis
-	curr_xform = mat_mult(xform_scale_mat(0.25f, 0.25f, 1.0f), xform_trans_mat(0.0f, 0.0f, 0.5f));
-	for (int i = 0; i < 36; ++i) {
-		pole_cube[i] = mat_vec_mult(curr_xform, base_cube[i]);
-	}
-
-	// -------------------- WALL --------------------
-	// create wall cube by moving up bottom slightly less thatn .5 units, then scaling to be thin on one axis
-	// NOTE: WALL IS THIN ON THE Y AXIS
-	curr_xform = mat_mult(xform_scale_mat(1.0f, 0.1f, 1.0f), xform_trans_mat(0.0f, 0.0f, 0.4f));
-	for (int i = 0; i < 36; ++i) {
-		wall_cube[i] = mat_vec_mult(curr_xform, base_cube[i]);
-	}
-
-	// -------------------- LINE --------------------
-	// create line cube by aligning with __________ axis and scaling to proper length
-	//curr_xform = mat_mult(xform_scale_mat(1.0f, 0.5f, 1.0f), mat_mult(xform_trans_mat(0.0f, -0.5f, 0.4f), xform_scale_mat(0.25f, 1.0f, 0.25f)));
-	curr_xform = mat_mult(xform_trans_mat(0.0f, -0.5f, 0.8f), xform_scale_mat(0.25f, 1.0f, 0.25f));
-	for (int i = 0; i < 36; ++i) {
-		line_cube[i] = mat_vec_mult(curr_xform, base_cube[i]);
-	}
-
-
-	// -----------------------------------------------------------
-	// ---------- COPY AND TRANSFORM CUBES TO FORM MAZE ----------
-	// -----------------------------------------------------------
-
-	// NOTE: maze is fomed in the +x -y quadrant of the xy plane to make construction easier by being able to directly
-	// take maze cell coordinates and place things
-
-	// GROUND
-	int index = 0;
-	for (int i = 0; i < 10; ++i) {
-		for (int j = 0; j < 10; ++j) {
-			for (int k = 0; k < 36; ++k) {
-				vertices[index] = floor_cube[k];
-				// move cube in one unit increments to form a floor
-				vertices[index].x += i;
-				vertices[index].y += j;
-				++index;
-			}
-		}
-	}
-
-	// POLES
-	for (int i = 0; i < 9; ++i) {
-		for (int j = 0; j < 9; ++j) {
-			for (int k = 0; k < 36; ++k) {
-				vertices[index] = pole_cube[k];
-				vertices[index].x += i + 0.5f;
-				vertices[index].y += j + 0.5f;
-				++index;
-			}
-		}
-	}
-
-	// VERTICAL WALLS
-	for (int i = 0; i < 8; ++i) {
-		for (int j = 0; j < 8; ++j) {
-			for (int k = 0; k < 36; ++k) {
-				if (maze[i][j].west_has_wall) {
-					vertices[index] = wall_cube[k];
-					vertices[index].x += i + 1.0f;
-					vertices[index].y += j + 0.5f;
-					++index;
-				}
-			}
-		}
-	}
-	for (int i = 0; i < 8; ++i) {
-		for (int j = 0; j < 36; ++j) {
-			if (maze[i][7].east_has_wall) {
-				vertices[index] = wall_cube[j];
-				vertices[index].x += i + 1.0f;
-				vertices[index].y += 8.5f;
-				++index;
-			}
-		}
-	}
-	// HORIZONTAL WALLS
-	curr_xform = xform_rot_mat('z', 3.14159f/2.0f);
-	for (int i = 0; i < 8; ++i) {
-		for (int j = 0; j < 8; ++j) {
-			for (int k = 0; k < 36; ++k) {
-				if (maze[i][j].north_has_wall) {
-					vertices[index] = mat_vec_mult(curr_xform, wall_cube[k]);
-					vertices[index].x += i + 0.5f;
-					vertices[index].y += j + 1.0f;
-					++index;
-				}
-			}
-		}
-	}
-	for (int i = 0; i < 8; ++i) {
-		for (int j = 0; j < 36; ++j) {
-			if (maze[7][i].south_has_wall) {
-				vertices[index] = mat_vec_mult(curr_xform, wall_cube[j]);
-				vertices[index].x += 8.5f;
-				vertices[index].y += i + 1.0f;
-				++index;
-			}
-		}
-	}
-
-
-	index = MAZE_VERTS;
-	// TEST CUBE
-	for (int i = 0; i < 36; ++i) {
-		vertices[index] = mat_vec_mult(curr_xform, line_cube[i]);
-		index++;
-	}
-
-	// center on screen
-	curr_xform = xform_trans_mat(-4.5f, -4.5f, 0.0f);
-	for (int i = 0; i < MAZE_VERTS; ++i) {
-		vertices[i] = mat_vec_mult(curr_xform, vertices[i]);
-	}
-	// scale to fit screen
-	curr_xform = xform_scale_mat(0.2f, 0.2f, 0.2f);
-	for (int i = 0; i < MAZE_VERTS; ++i) {
-		vertices[i] = mat_vec_mult(curr_xform, vertices[i]);
-	}
-	// rotate to make north up
-	curr_xform = xform_rot_mat('z', -3.14159f/2.0f);
-	for (int i = 0; i < MAZE_VERTS; ++i) {
-		vertices[i] = mat_vec_mult(curr_xform, vertices[i]);
-	}
-}
-
-
-int num_vertices = MAZE_VERTS + 36;
-
 // CAMERA CONTROL VARIABLES
 float scale = 0.8f;
 float up_down_rot = -0.5f;
@@ -552,7 +79,6 @@ bool is_animating = false;
 int current_step = 0;
 int max_steps = 100;
 
-mat4 anim_tranforms[66];
 float tick = 0.0f;
 
 void idle() {
@@ -571,17 +97,19 @@ void idle() {
 						)
 				   );
 
-	// logic for line animation
-	anim_tranforms[(int)tick] = mat_mult(
-					xform_trans_mat(1.0f, 0.0f, 0.0f),
-					mat_mult(
-					xform_scale_mat(-1.0f, 1.0f, 1.0f),
-					mat_mult(
-						xform_trans_mat(0.13f, 0.0f, 0.0f),
-						xform_scale_mat(tick - (int)tick, 1.0f, 1.0f)
-					    )));
+	// logic for line animation, stops once every line has been drawn
+	if ((int)tick < context.geometry.num_lines) {
+		context.geometry.anim_tranforms[(int)tick] = mat_mult(
+						xform_trans_mat(1.0f, 0.0f, 0.0f),
+						mat_mult(
+						xform_scale_mat(-1.0f, 1.0f, 1.0f),
+						mat_mult(
+							xform_trans_mat(0.13f, 0.0f, 0.0f),
+							xform_scale_mat(tick - (int)tick, 1.0f, 1.0f)
+						    )));
 
-	tick += .025;
+		tick += .025;
+	}
 
 	// thin out relative to camera view to avoid camera plane clipping
 	model_view_matrix = mat_mult(
@@ -592,10 +120,197 @@ void idle() {
 	glutPostRedisplay();
 }
 
+// build the transform of every line of the solution, the animation restarts after the first keep lines
+void build_line_tranforms(long long keep) {
+	if (!maze_geometry_build_lines(&context.geometry, &context.grid, &context.path, keep)) {
+		printf("ERROR: UNABLE TO ALLOCATE SOLUTION LINES\n");
+		exit(0);
+	}
+	if (tick > keep) { tick = keep; }
+}
+
+// how the maze is drawn, MAZE_GEOMETRY_* chosen from the command line
+int geometry_mode = MAZE_GEOMETRY_MESH;
+
+// build the vertices, the instances or the mesh of every wall that is up
+void create_geometry() {
+	bool built = false;
+	switch (geometry_mode) {
+		case MAZE_GEOMETRY_BAKED:
+			built = maze_geometry_build(&context.geometry, &context.grid); break;
+		case MAZE_GEOMETRY_INSTANCED:
+			built = maze_geometry_build_instances(&context.geometry, &context.grid); break;
+		case MAZE_GEOMETRY_MESH:
+			built = maze_geometry_build_mesh(&context.geometry, &context.grid); break;
+	}
+	if (!built) {
+		// baked and instanced geometry also stop at what GL can draw in one call
+		printf("ERROR: UNABLE TO BUILD MAZE GEOMETRY, OUT OF MEMORY OR TOO BIG FOR THIS -g MODE\n");
+		exit(0);
+	}
+}
+
+// buffer the maze geometry is uploaded to, and the instances on the instanced path.
+// the vertices or the wall instances are written again whenever a wall is edited
+GLuint vertex_buffer;
+GLuint instance_buffer;
+
+// per instance attribute and the matrix that fits the instanced maze and the mesh to the screen
+GLuint vInstance;
+GLuint maze_matrix_location;
+mat4 maze_matrix;
+
+// the mesh counts its texture coordinates in whole tiles and keeps the kind of cube in them, which
+// the shaders turn into the part of the texture of that kind
+GLuint repeat_tiles_location;
+
+// the mesh stores positions as whole steps from the offset of their chunk, decoded in the vertex shader
+GLuint position_scale_location;
+GLuint position_offset_location;
+static const float no_offset[3] = { 0.0f, 0.0f, 0.0f };
+
+// first vertex of the line cube in the vertex buffer
+int line_first_vertex;
+
+// index buffer of the mesh and the type of its indices
+GLuint index_buffer;
+GLenum index_type;
+
+// chunks whose cells come out smaller than this many pixels on screen are drawn as their far quad,
+// colored from the wall bits by how much of each spot is wall
+#define LOD_CELL_PIXELS 3.0f
+GLuint lod_location;
+GLuint wall_bits_texture;
+bool has_wall_bits;
+// index ranges of the far quads drawn this frame, adjacent chunks share one range
+GLsizei* lod_counts;
+const GLvoid** lod_offsets;
+
+// draw count faces of the mesh starting at face first
+void draw_faces(int first, int count) {
+	glDrawElements(GL_TRIANGLES, 6 * count, index_type,
+		BUFFER_OFFSET((size_t)6 * first * context.geometry.mesh_index_size));
+}
+
+// whether any of a chunk is on screen, with the size of one of its cells on screen in pixels. clip takes
+// maze units to clip space, a chunk is off screen when all the corners of its box are past the same plane
+static bool project_chunk(mat4 clip, const maze_chunk* chunk, float* cell_pixels) {
+	int outside[6] = { 0, 0, 0, 0, 0, 0 };
+	float low[2] = { 1e30f, 1e30f };
+	float high[2] = { -1e30f, -1e30f };
+	for (int corner = 0; corner < 8; ++corner) {
+		vec4 point = { (corner & 1) ? chunk->max[0] : chunk->min[0], (corner & 2) ? chunk->max[1] : chunk->min[1],
+			(corner & 4) ? chunk->max[2] : chunk->min[2], 1.0f };
+		vec4 projected = mat_vec_mult(clip, point);
+		const float* axes = &projected.x;
+		for (int axis = 0; axis < 3; ++axis) {
+			if (axes[axis] < -projected.w) { ++outside[2 * axis]; }
+			if (axes[axis] > projected.w) { ++outside[2 * axis + 1]; }
+		}
+		for (int axis = 0; axis < 2; ++axis) {
+			if (axes[axis] / projected.w < low[axis]) { low[axis] = axes[axis] / projected.w; }
+			if (axes[axis] / projected.w > high[axis]) { high[axis] = axes[axis] / projected.w; }
+		}
+	}
+	for (int plane = 0; plane < 6; ++plane) {
+		if (outside[plane] == 8) { return false; }
+	}
+
+	// the viewport is 800 pixels across, 400 per unit of clip space
+	float extent = (high[0] - low[0] > high[1] - low[1]) ? high[0] - low[0] : high[1] - low[1];
+	int cells = (chunk->rows > chunk->cols) ? chunk->rows : chunk->cols;
+	*cell_pixels = extent * 400.0f / cells;
+	return true;
+}
+
+// write the walls that changed since the last build into the buffers
+void upload_geometry() {
+	const maze_geometry* geometry = &context.geometry;
+	if (geometry_mode == MAZE_GEOMETRY_BAKED) {
+		glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, (geometry->maze_verts + 36) * sizeof(vec4), geometry->vertices);
+		return;
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, instance_buffer);
+	glBufferSubData(GL_ARRAY_BUFFER, geometry->first_instance[MAZE_CUBE_WALL] * sizeof(maze_instance),
+		geometry->num_instances[MAZE_CUBE_WALL] * sizeof(maze_instance),
+		geometry->instances + geometry->first_instance[MAZE_CUBE_WALL]);
+}
+
+// bring the geometry up to date after the wall on the given side of a cell changed. the mesh only
+// rebuilds and uploads the walls of the one chunk that holds it and its part of the wall bits
+void update_geometry(int row, int col, int direction) {
+	if (geometry_mode != MAZE_GEOMETRY_MESH) {
+		create_geometry();
+		upload_geometry();
+		return;
+	}
+
+	const maze_geometry* geometry = &context.geometry;
+	const maze_chunk* chunk = &geometry->chunks[maze_geometry_update_mesh(&context.geometry, &context.grid, row, col, direction)];
+	int first = 4 * (chunk->first_face + chunk->fixed_faces);
+	glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+	glBufferSubData(GL_ARRAY_BUFFER, first * sizeof(maze_mesh_vertex), 4 * chunk->wall_faces * sizeof(maze_mesh_vertex),
+		geometry->mesh_vertices + first);
+
+	if (has_wall_bits) {
+		// the texels of the chunk, from the poles on its north west corner to the ones on its south east corner
+		int first_row = 2 * chunk->row, first_col = 2 * chunk->col;
+		glActiveTexture(GL_TEXTURE1);
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, geometry->wall_bits_width);
+		glPixelStorei(GL_UNPACK_SKIP_ROWS, first_row);
+		glPixelStorei(GL_UNPACK_SKIP_PIXELS, first_col);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, first_col, first_row, 2 * chunk->cols + 1, 2 * chunk->rows + 1,
+			GL_RED, GL_UNSIGNED_BYTE, geometry->wall_bits);
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+		glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+		glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+		glGenerateMipmap(GL_TEXTURE_2D);
+		glActiveTexture(GL_TEXTURE0);
+	}
+}
+
+// open or close a random inner wall, then update the walls on screen and the solution lines
+void edit_random_wall(bool wall) {
+	// most picks are already the right way or on the border, so keep picking until one changes
+	static const char* direction_names[] = { "", "north", "east", "south", "west" };
+	for (int attempt = 0; attempt < 1000; ++attempt) {
+		int row = maze_rng_below(&context.rng, context.grid.height);
+		int col = maze_rng_below(&context.rng, context.grid.width);
+		int direction = 1 + maze_rng_below(&context.rng, 4);
+		long long old_length = context.path.length;
+		if (!maze_context_set_wall(&context, row, col, direction, wall)) {
+			// the editor is set up on the first edit, which is the only thing that can run out of memory
+			if (!context.editor_ready) {
+				printf("ERROR: UNABLE TO ALLOCATE MAZE EDITOR\n");
+				exit(0);
+			}
+			continue;
+		}
+
+		const maze_edit* editor = &context.editor;
+		printf("%s the %s wall of (%i, %i): %lli cells touched, path length %lli\n", wall ? "Closed" : "Opened",
+			direction_names[direction], row, col, editor->touched, context.path.length);
+
+		update_geometry(row, col, direction);
+
+		// line i leads into step i, so the lines before the first changed step stay as they are
+		if (editor->first_change < context.path.length || context.path.length != old_length) {
+			build_line_tranforms((editor->first_change < old_length) ? editor->first_change : old_length);
+		}
+		return;
+	}
+}
+
 void init(void)
 {
 	// OPEN IMAGE FILE AND CREATE NECESSARY DATA
-	GLubyte my_texels[800][800][3];
+	// the texture is only needed until it is uploaded, so it goes on the heap and not the stack
+	GLubyte (*my_texels)[800][3] = malloc(800 * sizeof(*my_texels));
+	if (my_texels == NULL) {
+		printf("ERROR: UNABLE TO ALLOCATE TEXTURE\n");
+		exit(0);
+	}
 
 	FILE *fp;
 
@@ -609,113 +324,141 @@ void init(void)
 
 	fclose(fp);
 
-	// GENERATE TEXTURE COORDINATES
-	GLfloat tex_coords[MAZE_VERTS][2];
-	
-	// ground
-	for (int i = 0; i < 3600; /**/) {
-		tex_coords[i][0] = 0.0f + 0.0f;
-		tex_coords[i][1] = 0.0f + 0.5f;
-		++i;
-		tex_coords[i][0] = 0.0f + 0.0f;
-		tex_coords[i][1] = 0.5f + 0.5f;
-		++i;
-		tex_coords[i][0] = 0.5f + 0.0f;
-		tex_coords[i][1] = 0.5f + 0.5f;
-		++i;
-		tex_coords[i][0] = 0.0f + 0.0f;
-		tex_coords[i][1] = 0.0f + 0.5f;
-		++i;
-		tex_coords[i][0] = 0.5f + 0.0f;
-		tex_coords[i][1] = 0.5f + 0.5f;
-		++i;
-		tex_coords[i][0] = 0.5f + 0.0f;
-		tex_coords[i][1] = 0.0f + 0.5f;
-		++i;
-	}
-	
-	// poles
-	for (int i = 3600; i < 3600+2916; /**/) {
-		tex_coords[i][0] = 0.0f + 0.5f;
-		tex_coords[i][1] = 0.0f + 0.0f;
-		++i;
-		tex_coords[i][0] = 0.0f + 0.5f;
-		tex_coords[i][1] = 0.5f + 0.0f;
-		++i;
-		tex_coords[i][0] = 0.5f + 0.5f;
-		tex_coords[i][1] = 0.5f + 0.0f;
-		++i;
-		tex_coords[i][0] = 0.0f + 0.5f;
-		tex_coords[i][1] = 0.0f + 0.0f;
-		++i;
-		tex_coords[i][0] = 0.5f + 0.5f;
-		tex_coords[i][1] = 0.5f + 0.0f;
-		++i;
-		tex_coords[i][0] = 0.5f + 0.5f;
-		tex_coords[i][1] = 0.0f + 0.0f;
-		++i;
-	}
-	 
-	// walls
-	for (int i = 2916+3600; i < 3600+2916+5184; /**/) {
-		tex_coords[i][0] = 0.0f + 0.0f;
-		tex_coords[i][1] = 0.0f + 0.0f;
-		++i;
-		tex_coords[i][0] = 0.0f + 0.0f;
-		tex_coords[i][1] = 0.5f + 0.0f;
-		++i;
-		tex_coords[i][0] = 0.5f + 0.0f;
-		tex_coords[i][1] = 0.5f + 0.0f;
-		++i;
-		tex_coords[i][0] = 0.0f + 0.0f;
-		tex_coords[i][1] = 0.0f + 0.0f;
-		++i;
-		tex_coords[i][0] = 0.5f + 0.0f;
-		tex_coords[i][1] = 0.5f + 0.0f;
-		++i;
-		tex_coords[i][0] = 0.5f + 0.0f;
-		tex_coords[i][1] = 0.0f + 0.0f;
-		++i;
-	}
-
     GLuint program = initShader("vshader.glsl", "fshader.glsl");
     glUseProgram(program);
 
+    // the far quads of the mesh blend between the average color of the floor quarter of the texture and
+    // the average of the whole texture, which is what the thin tops of walls and poles fade to from far away
+    float floor_color[3] = { 0.0f, 0.0f, 0.0f };
+    float wall_color[3] = { 0.0f, 0.0f, 0.0f };
+    for (int i = 0; i < 800; ++i) {
+	for (int j = 0; j < 800; ++j) {
+	    for (int k = 0; k < 3; ++k) {
+		if (i >= 400 && j < 400) { floor_color[k] += my_texels[i][j][k] / (255.0f * 400 * 400); }
+		wall_color[k] += my_texels[i][j][k] / (255.0f * 800 * 800);
+	    }
+	}
+    }
+    glUniform3fv(glGetUniformLocation(program, "floor_color"), 1, floor_color);
+    glUniform3fv(glGetUniformLocation(program, "wall_color"), 1, wall_color);
+
     //
     GLuint mytex;
     glGenTextures(1, &mytex);
     glBindTexture(GL_TEXTURE_2D, mytex);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 800, 800, 0, GL_RGB, GL_UNSIGNED_BYTE, my_texels);
+    free(my_texels);
     glGenerateMipmap(GL_TEXTURE_2D);
     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
+    glUniform1i(glGetUniformLocation(program, "maze_texture"), 0);
     //
 
     GLuint vao;
     glGenVertexArrays(1, &vao);
     glBindVertexArray(vao);
 
-    GLuint buffer;
-    glGenBuffers(1, &buffer);
-    glBindBuffer(GL_ARRAY_BUFFER, buffer);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices) + sizeof(tex_coords), NULL, GL_STATIC_DRAW);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-    glBufferSubData(GL_ARRAY_BUFFER, sizeof(vertices), sizeof(tex_coords), tex_coords);
-
     GLuint vPosition = glGetAttribLocation(program, "vPosition");
-    glEnableVertexAttribArray(vPosition);
-    glVertexAttribPointer(vPosition, 4, GL_FLOAT, GL_FALSE, 0, BUFFER_OFFSET(0));
-
     GLuint vTexCoord = glGetAttribLocation(program, "vTexCoord");
+    vInstance = glGetAttribLocation(program, "vInstance");
+    maze_matrix_location = glGetUniformLocation(program, "maze_matrix");
+    repeat_tiles_location = glGetUniformLocation(program, "repeat_tiles");
+    lod_location = glGetUniformLocation(program, "lod");
+    position_scale_location = glGetUniformLocation(program, "position_scale");
+    position_offset_location = glGetUniformLocation(program, "position_offset");
+    const maze_geometry* geometry = &context.geometry;
+
+    glGenBuffers(1, &vertex_buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+    if (geometry_mode == MAZE_GEOMETRY_BAKED) {
+	// vertices and texture coordinates were both built with the geometry, already fit to the screen
+	size_t vertices_size = (geometry->maze_verts + 36) * sizeof(vec4);
+	size_t tex_coords_size = (geometry->maze_verts + 36) * sizeof(*geometry->tex_coords);
+	glBufferData(GL_ARRAY_BUFFER, vertices_size + tex_coords_size, NULL, GL_STATIC_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, vertices_size, geometry->vertices);
+	glBufferSubData(GL_ARRAY_BUFFER, vertices_size, tex_coords_size, geometry->tex_coords);
+	glVertexAttribPointer(vPosition, 4, GL_FLOAT, GL_FALSE, 0, BUFFER_OFFSET(0));
+	glVertexAttribPointer(vTexCoord, 2, GL_FLOAT, GL_FALSE, 0, BUFFER_OFFSET(vertices_size));
+	line_first_vertex = geometry->maze_verts;
+	maze_matrix = og_view_matrix;
+    } else if (geometry_mode == MAZE_GEOMETRY_MESH) {
+	// the whole mesh with room for the most runs of walls each chunk can have, so edits never have to grow
+	// the buffer. position and texture coordinates sit side by side as whole numbers that convert to floats
+	// exactly, w is left out and reads as 1
+	glBufferData(GL_ARRAY_BUFFER, 4 * geometry->mesh_capacity * sizeof(maze_mesh_vertex), geometry->mesh_vertices, GL_DYNAMIC_DRAW);
+	glVertexAttribPointer(vPosition, 3, GL_SHORT, GL_FALSE, sizeof(maze_mesh_vertex), BUFFER_OFFSET(0));
+	glVertexAttribPointer(vTexCoord, 2, GL_UNSIGNED_BYTE, GL_FALSE, sizeof(maze_mesh_vertex), BUFFER_OFFSET(3 * sizeof(short)));
+
+	// the indices cover every face there is room for and are uploaded once
+	glGenBuffers(1, &index_buffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, 6 * geometry->mesh_capacity * geometry->mesh_index_size, geometry->mesh_indices, GL_STATIC_DRAW);
+	index_type = (geometry->mesh_index_size == 2) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+	// one byte per pole, wall and cell on the second texture unit, outside the maze reads as floor
+	GLint max_texture_size;
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_texture_size);
+	has_wall_bits = geometry->wall_bits != NULL && geometry->wall_bits_width <= max_texture_size
+		&& geometry->wall_bits_height <= max_texture_size;
+	if (has_wall_bits) {
+	    glActiveTexture(GL_TEXTURE1);
+	    glGenTextures(1, &wall_bits_texture);
+	    glBindTexture(GL_TEXTURE_2D, wall_bits_texture);
+	    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, geometry->wall_bits_width, geometry->wall_bits_height, 0,
+		GL_RED, GL_UNSIGNED_BYTE, geometry->wall_bits);
+	    glGenerateMipmap(GL_TEXTURE_2D);
+	    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+	    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+	    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	    glActiveTexture(GL_TEXTURE0);
+	    glUniform1i(glGetUniformLocation(program, "wall_bits"), 1);
+	    glUniform2f(glGetUniformLocation(program, "wall_bits_size"), geometry->wall_bits_width, geometry->wall_bits_height);
+	}
+
+	// the far quads of every chunk could be drawn in one frame
+	lod_counts = malloc(geometry->num_chunks * sizeof(*lod_counts));
+	lod_offsets = malloc(geometry->num_chunks * sizeof(*lod_offsets));
+	if (lod_counts == NULL || lod_offsets == NULL) {
+	    printf("ERROR: UNABLE TO ALLOCATE CHUNK LIST\n");
+	    exit(0);
+	}
+	maze_matrix = maze_geometry_fit_xform(&context.grid);
+    } else {
+	// one unit cube of each kind, moved into place by the instances and fit to the screen in the shader
+	glBufferData(GL_ARRAY_BUFFER, sizeof(geometry->cube_vertices) + sizeof(geometry->cube_tex_coords), NULL, GL_STATIC_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(geometry->cube_vertices), geometry->cube_vertices);
+	glBufferSubData(GL_ARRAY_BUFFER, sizeof(geometry->cube_vertices), sizeof(geometry->cube_tex_coords), geometry->cube_tex_coords);
+	glVertexAttribPointer(vPosition, 4, GL_FLOAT, GL_FALSE, 0, BUFFER_OFFSET(0));
+	glVertexAttribPointer(vTexCoord, 2, GL_FLOAT, GL_FALSE, 0, BUFFER_OFFSET(sizeof(geometry->cube_vertices)));
+	line_first_vertex = MAZE_CUBE_LINE * 36;
+	maze_matrix = maze_geometry_fit_xform(&context.grid);
+
+	// room for every wall to be up, so edits never have to grow the buffer
+	glGenBuffers(1, &instance_buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, instance_buffer);
+	glBufferData(GL_ARRAY_BUFFER, geometry->max_instances * sizeof(maze_instance), NULL, GL_DYNAMIC_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, (geometry->first_instance[MAZE_CUBE_WALL] + geometry->num_instances[MAZE_CUBE_WALL])
+		* sizeof(maze_instance), geometry->instances);
+	glVertexAttribDivisor(vInstance, 1);
+    }
+    glEnableVertexAttribArray(vPosition);
     glEnableVertexAttribArray(vTexCoord);
-    glVertexAttribPointer(vTexCoord, 2, GL_FLOAT, GL_FALSE, 0, (GLvoid *) 0 + sizeof(vertices));
+    // vertices that are already placed read a zero instance, and only the mesh needs decoding
+    glVertexAttrib3f(vInstance, 0.0f, 0.0f, 0.0f);
+    glUniform1f(position_scale_location, 1.0f);
+    glUniform3fv(position_offset_location, 1, no_offset);
 
     model_view_matrix_location = glGetUniformLocation(program, "model_view_matrix");
     use_texture_location = glGetUniformLocation(program, "use_texture");
 
+    // every cube is wound counter clockwise seen from outside, so faces turned away are never drawn
     glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+    glCullFace(GL_BACK);
     glClearColor(0.0, 0.0, 0.0, 1.0);
     glDepthRange(1,0);
 }
@@ -729,26 +472,86 @@ void display(void)
 
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    glPolygonMode(GL_FRONT, GL_FILL);
-    glPolygonMode(GL_BACK, GL_LINE);
+    // zooming out past zero mirrors the view, which turns every face around
+    glFrontFace((scale < 0.0f) ? GL_CW : GL_CCW);
 
     glUniformMatrix4fv(model_view_matrix_location, 1, GL_FALSE, (GLfloat *) &model_view_matrix);
 
     // draw maze itself
     glUniform1i(use_texture_location, 1); // switch to using textures
-    glDrawArrays(GL_TRIANGLES, 0, MAZE_VERTS);
+    const maze_geometry* geometry = &context.geometry;
+    glUniformMatrix4fv(maze_matrix_location, 1, GL_FALSE, (GLfloat *) &maze_matrix);
+    if (geometry_mode == MAZE_GEOMETRY_BAKED) {
+	glDrawArrays(GL_TRIANGLES, 0, geometry->maze_verts);
+    } else if (geometry_mode == MAZE_GEOMETRY_MESH) {
+	// every chunk on screen is one draw of its floor, poles and walls, or when its cells are too small to
+	// make out, a far quad gathered into one draw with the others
+	mat4 clip = mat_mult(model_view_matrix, maze_matrix);
+	int lod_ranges = 0;
+	glUniform1f(position_scale_location, 1.0f / MAZE_MESH_STEPS);
+	glUniform1i(repeat_tiles_location, 1);
+	for (int c = 0; c < geometry->num_chunks; ++c) {
+	    const maze_chunk* chunk = &geometry->chunks[c];
+	    float cell_pixels;
+	    if (!project_chunk(clip, chunk, &cell_pixels)) { continue; }
+
+	    if (has_wall_bits && cell_pixels < LOD_CELL_PIXELS) {
+		int first = geometry->lod_first_face + 2 * c;
+		GLvoid* offset = BUFFER_OFFSET((size_t)6 * first * geometry->mesh_index_size);
+		if (lod_ranges > 0 && (char*)lod_offsets[lod_ranges - 1] + lod_counts[lod_ranges - 1] * geometry->mesh_index_size == offset) {
+		    lod_counts[lod_ranges - 1] += 12;
+		} else {
+		    lod_offsets[lod_ranges] = offset;
+		    lod_counts[lod_ranges++] = 12;
+		}
+		continue;
+	    }
+	    glUniform3fv(position_offset_location, 1, chunk->offset);
+	    draw_faces(chunk->first_face, chunk->fixed_faces + chunk->wall_faces);
+	}
+	if (lod_ranges > 0) {
+	    glUniform1f(position_scale_location, 1.0f / MAZE_MESH_LOD_STEPS);
+	    glUniform3fv(position_offset_location, 1, no_offset);
+	    glUniform1i(lod_location, 1);
+	    glMultiDrawElements(GL_TRIANGLES, lod_counts, index_type, lod_offsets, lod_ranges);
+	    glUniform1i(lod_location, 0);
+	}
+	glUniform1i(repeat_tiles_location, 0);
+    } else {
+	// one draw per kind of cube, with the instances of that kind
+	glBindBuffer(GL_ARRAY_BUFFER, instance_buffer);
+	glEnableVertexAttribArray(vInstance);
+	for (int kind = MAZE_CUBE_FLOOR; kind <= MAZE_CUBE_WALL; ++kind) {
+	    glVertexAttribPointer(vInstance, 3, GL_FLOAT, GL_FALSE, 0,
+		BUFFER_OFFSET(geometry->first_instance[kind] * sizeof(maze_instance)));
+	    glDrawArraysInstanced(GL_TRIANGLES, kind * 36, 36, geometry->num_instances[kind]);
+	}
+	glDisableVertexAttribArray(vInstance);
+	// the current value of the attribute is undefined after drawing from the array, and the lines read it
+	glVertexAttrib3f(vInstance, 0.0f, 0.0f, 0.0f);
+    }
+    // the line transforms already fit the lines to the screen
+    glUniformMatrix4fv(maze_matrix_location, 1, GL_FALSE, (GLfloat *) &og_view_matrix);
+    if (geometry_mode == MAZE_GEOMETRY_MESH) {
+	glUniform1f(position_scale_location, 1.0f / MAZE_MESH_STEPS);
+	glUniform3fv(position_offset_location, 1, no_offset);
+    }
 
     // save model view matrix
 
     glUniform1i(use_texture_location, 0); // switch to using solid color
+    // the animation mirrors every line, which turns its faces around
+    glFrontFace((scale < 0.0f) ? GL_CCW : GL_CW);
     // draw animated solve lines
-    for (int i = 0; i < 66; ++i) {
-	model_view_matrix = mat_mult(orig_model_view_matrix, mat_mult(line_tranforms[i], anim_tranforms[i]));
+    for (int i = 0; i < context.geometry.num_lines; ++i) {
+	model_view_matrix = mat_mult(orig_model_view_matrix,
+		mat_mult(context.geometry.line_tranforms[i], context.geometry.anim_tranforms[i]));
 	//model_view_matrix = line_tranforms[i];
         glUniformMatrix4fv(model_view_matrix_location, 1, GL_FALSE, (GLfloat *) &model_view_matrix);
 
 	//mat_print(model_view_matrix);
-    	glDrawArrays(GL_TRIANGLES, MAZE_VERTS, 36);
+	if (geometry_mode == MAZE_GEOMETRY_MESH) { draw_faces(0, 6); }
+	else { glDrawArrays(GL_TRIANGLES, line_first_vertex, 36); }
     }
     glUniform1i(use_texture_location, 1); // switch to using textures
 
@@ -761,6 +564,10 @@ void keyboard(unsigned char key, int mousex, int mousey)
 {
     if(key == 'q')
     	glutLeaveMainLoop();
+    if(key == 'o')
+    	edit_random_wall(false);
+    if(key == 'c')
+    	edit_random_wall(true);
 
     //glutPostRedisplay();
 }
@@ -815,70 +622,154 @@ void reshape(int width, int height)
 
 int steps = 0;
 
+// print command line usage
+void usage(const char* program_name) {
+	printf("usage: %s [-w width] [-h height] [-s seed] [-a backtracker|eller|tiled|kruskal] [-t threads] [-m rowmajor|morton]\n", program_name);
+	printf("       %s [-r wall|bfs|astar|bidir|flood|fill|tree]\n", program_name);
+	printf("       %s [-l file] [-b file] [-g baked|instanced|mesh]\n", program_name);
+	printf("       %s -n count [-o file] [-b prefix] [-w width] [-h height] [-s seed] [-a algorithm] [-t threads] [-r solver] [-m layout]\n", program_name);
+	printf("       -l loads a binary maze file instead of generating, -b saves the maze as a binary maze file\n");
+	printf("       -m stores the cells in Z order tiles, which keeps neighbors close in memory on huge grids\n");
+	printf("       -r picks the solver, the left hand wall follower, a breadth first, A* or bidirectional search,\n");
+	printf("          a bitset distance flood, dead end filling or a walk over the tree index of the maze\n");
+	printf("       -g draws every cube of the maze from one array, draws one unit cube per kind instanced,\n");
+	printf("          or draws a mesh of only the faces that can be seen with runs of walls merged, in chunks\n");
+	printf("          culled to the screen that turn into flat quads from far away\n");
+	printf("       -n generates and solves count mazes headless on the worker threads and reports throughput\n");
+}
+
+// generate and solve a batch of mazes without ever opening a window
+int run_headless(const maze_context* settings, int count, const char* output_path, const char* binary_prefix) {
+	maze_batch_options options;
+	options.width = settings->width;
+	options.height = settings->height;
+	options.count = count;
+	options.num_threads = settings->num_threads;
+	options.algorithm = settings->algorithm;
+	options.layout = settings->layout;
+	options.solver = settings->solver;
+	options.seed = settings->seed;
+	options.output_path = output_path;
+	options.binary_prefix = binary_prefix;
+
+	maze_batch_result result;
+	if (!run_maze_batch(&options, &result)) {
+		printf("ERROR: MAZE BATCH FAILED\n");
+		return 1;
+	}
+
+	double cells = (double)settings->width * settings->height * count;
+	printf("Seeds: %llu to %llu\n", settings->seed, settings->seed + count - 1);
+	printf("Generated and solved %i %ix%i %s mazes with %s on %i threads in %.3f s\n",
+		count, settings->width, settings->height, maze_algorithm_name(settings->algorithm),
+		maze_solver_name(settings->solver), settings->num_threads, result.seconds);
+	printf("%.1f mazes/s, %.0f cells/s, average path length %.1f\n",
+		count / result.seconds, cells / result.seconds, (double)result.total_path_length / count);
+	printf("Solving took %.3f ms and expanded %.0f cells per maze\n",
+		result.solve_seconds * 1e3 / count, (double)result.total_expanded / count);
+	return 0;
+}
+
 int main(int argc, char **argv)
 {
-	
-	start_maze_generation();
-	print_maze();
-	solve_maze();
-	create_geometry();
-	
-
-	// matrix that matches transforms applied to the maze itself
-	mat4 maze_match_xform = mat_mult(xform_rot_mat('z', -3.14159f/2.0f), mat_mult(xform_scale_mat(0.2f, 0.2f, 0.2f), xform_trans_mat(-4.5f, -4.5f, 0.0f)));
-	
-	struct node* temp_head = head;
-	float line_x_trans = 1.0f;
-	float line_y_trans = 0.0f;
-	float line_rot = 0.0f;
-
-	int i = 0;
-	// initialize all line transforms to proper values
-	for (   ; i < 66; ++i) {
-		
-		if (temp_head->next == NULL) { break; }
-
-		switch (temp_head->orientation) {
-			case north:
-				line_rot = 0.0f; break;
-			case south:
-				line_rot = 3.14159f; break;
-			case east:
-				line_rot = -3.14159f/2.0f; break;
-			case west:
-				line_rot = 3.14159f/2.0f; break;
+	// read maze dimensions and seed from the command line
+	maze_context_init(&context);
+	context.seed = (unsigned long long)time(0);
+	int batch_count = 0;
+	const char* output_path = NULL;
+	const char* binary_path = NULL;
+	const char* load_path = NULL;
+	int opt;
+	while ((opt = getopt(argc, argv, "w:h:s:a:t:m:r:n:o:b:l:g:")) != -1) {
+		switch (opt) {
+			case 'w':
+				context.width = atoi(optarg); break;
+			case 'h':
+				context.height = atoi(optarg); break;
+			case 's':
+				context.seed = strtoull(optarg, NULL, 0); break;
+			case 'a':
+				context.algorithm = maze_algorithm_from_name(optarg);
+				if (context.algorithm < 0) { usage(argv[0]); return 1; }
+				break;
+			case 't':
+				context.num_threads = atoi(optarg); break;
+			case 'm':
+				context.layout = maze_layout_from_name(optarg);
+				if (context.layout < 0) { usage(argv[0]); return 1; }
+				break;
+			case 'r':
+				context.solver = maze_solver_from_name(optarg);
+				if (context.solver < 0) { usage(argv[0]); return 1; }
+				break;
+			case 'n':
+				batch_count = atoi(optarg); break;
+			case 'o':
+				output_path = optarg; break;
+			case 'b':
+				binary_path = optarg; break;
+			case 'l':
+				load_path = optarg; break;
+			case 'g':
+				geometry_mode = maze_geometry_mode_from_name(optarg);
+				if (geometry_mode < 0) { usage(argv[0]); return 1; }
+				break;
+			default:
+				usage(argv[0]); return 1;
 		}
+	}
+	if (context.width < 1 || context.height < 1 || context.num_threads < 1 || batch_count < 0) {
+		usage(argv[0]);
+		return 1;
+	}
 
-		line_tranforms[i] = mat_mult(
-					maze_match_xform,
-					mat_mult(
-						xform_trans_mat((float)temp_head->row + 1, (float)temp_head->col + 1, 0.0f),
-						xform_rot_mat('z', line_rot)
-						)
-					    );
-
-		switch (temp_head->orientation) {
-			case north:
-				line_x_trans += 0.0f; line_y_trans -= 1.0f; break;
-			case south:
-				line_x_trans += 0.0f; line_y_trans += 1.0f; break;
-			case east:
-				line_x_trans += 1.0f; line_y_trans += 0.0f; break;
-			case west:
-				line_x_trans -= 1.0f; line_y_trans += 0.0f; break;
-		}
-		
-		temp_head = temp_head->next;
+	if (batch_count > 0) {
+		return run_headless(&context, batch_count, output_path, binary_path);
 	}
 
-	// Add final two lines to maze exit
-	if (temp_head->orientation == south) {
-		line_tranforms[i] = mat_mult(maze_match_xform, mat_mult(xform_trans_mat((float)8, (float)8, 0.0f), xform_rot_mat('z', 3.14159f)));
+	if (load_path != NULL) {
+		// take the maze and where it came from out of the file instead of generating it
+		maze_file file;
+		if (!maze_file_open(&file, load_path) || !maze_context_load(&context, &file)) {
+			printf("ERROR: UNABLE TO LOAD MAZE FILE %s\n", load_path);
+			exit(0);
+		}
+		maze_file_close(&file);
+		printf("Seed: %llu\n", context.seed);
+		printf("Loaded %ix%i maze from %s\n", context.width, context.height, load_path);
 	} else {
-		line_tranforms[i] = mat_mult(maze_match_xform, mat_mult(xform_trans_mat((float)8, (float)8, 0.0f), xform_rot_mat('z', -3.14159f/2.0f)));
+		struct timespec gen_start, gen_end;
+		clock_gettime(CLOCK_MONOTONIC, &gen_start);
+		if (!maze_context_generate(&context)) {
+			printf("ERROR: UNABLE TO ALLOCATE %ix%i MAZE\n", context.width, context.height);
+			exit(0);
+		}
+		clock_gettime(CLOCK_MONOTONIC, &gen_end);
+		printf("Seed: %llu\n", context.seed);
+		printf("Generated %ix%i maze in %.3f s\n", context.width, context.height,
+			(gen_end.tv_sec - gen_start.tv_sec) + (gen_end.tv_nsec - gen_start.tv_nsec) / 1e9);
+	}
+
+	if (binary_path != NULL && !maze_file_save(binary_path, &context.grid, context.seed, context.algorithm)) {
+		printf("ERROR: UNABLE TO SAVE MAZE FILE %s\n", binary_path);
+		exit(0);
 	}
-	i += 1;
-	line_tranforms[i] = mat_mult(maze_match_xform, mat_mult(xform_trans_mat((float)9, (float)8, 0.0f), xform_rot_mat('z', 3.14159f)));
+	maze_grid_print(&context.grid, stdout);
+	struct timespec solve_start, solve_end;
+	clock_gettime(CLOCK_MONOTONIC, &solve_start);
+	bool solved = maze_context_solve(&context);
+	clock_gettime(CLOCK_MONOTONIC, &solve_end);
+	if (!solved) {
+		printf("ERROR: UNABLE TO ALLOCATE MAZE SOLUTION\n");
+		exit(0);
+	}
+	printf("Solved with %s in %.3f ms, %lli cells expanded, path length %lli\n", maze_solver_name(context.solver),
+		((solve_end.tv_sec - solve_start.tv_sec) + (solve_end.tv_nsec - solve_start.tv_nsec) / 1e9) * 1e3,
+		context.search.expanded, context.path.length);
+	create_geometry();
+
+
+	build_line_tranforms(0);
 	
 
     glutInit(&argc, argv);
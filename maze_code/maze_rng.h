@@ -0,0 +1,81 @@
+#ifndef _MAZE_RNG_H_
+#define _MAZE_RNG_H_
+
+#include <stdint.h>
+
+// +----------------------------------------------------------------------+
+// |                                                                      |
+// |                               RNG                                    |
+// |                                                                      |
+// +----------------------------------------------------------------------+
+
+// small seedable xoshiro256** generator, every generator call takes its own so
+// runs can be replayed from a seed and threads never share random state
+
+// +---------------------+
+// |   TYPE DEFINITION   |
+// +---------------------+
+
+typedef struct {
+	uint64_t s[4];
+} maze_rng;
+
+// +---------------+
+// |   FUNCTIONS   |
+// +---------------+
+
+// splitmix64 step, used to spread a single seed over the whole state
+static inline uint64_t maze_rng_splitmix(uint64_t* x) {
+	uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+// seed the generator, the same seed always gives the same sequence
+static inline void maze_rng_seed(maze_rng* rng, uint64_t seed) {
+	for (int i = 0; i < 4; ++i) {
+		rng->s[i] = maze_rng_splitmix(&seed);
+	}
+}
+
+static inline uint64_t maze_rng_rotl(uint64_t x, int k) {
+	return (x << k) | (x >> (64 - k));
+}
+
+// next 64 random bits
+static inline uint64_t maze_rng_next(maze_rng* rng) {
+	uint64_t* s = rng->s;
+	uint64_t result = maze_rng_rotl(s[1] * 5, 7) * 9;
+	uint64_t t = s[1] << 17;
+
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = maze_rng_rotl(s[3], 45);
+
+	return result;
+}
+
+// uniform random number in [0, bound) without modulo bias (multiply and reject, Lemire)
+static inline uint32_t maze_rng_below(maze_rng* rng, uint32_t bound) {
+	uint64_t m = (maze_rng_next(rng) >> 32) * bound;
+	uint32_t low = (uint32_t)m;
+	if (low < bound) {
+		uint32_t threshold = -bound % bound;
+		while (low < threshold) {
+			m = (maze_rng_next(rng) >> 32) * bound;
+			low = (uint32_t)m;
+		}
+	}
+	return (uint32_t)(m >> 32);
+}
+
+// derive an independent generator, for handing out one per thread or per maze
+static inline void maze_rng_split(maze_rng* rng, maze_rng* child) {
+	maze_rng_seed(child, maze_rng_next(rng));
+}
+
+#endif
@@ -0,0 +1,440 @@
+#include <stdlib.h>
+#include <string.h>
+#include "maze_search.h"
+
+// +---------------+
+// |   FUNCTIONS   |
+// +---------------+
+
+// set up searches that own no memory yet
+void maze_search_init(maze_search* search) {
+	maze_search_init_arena(search, NULL);
+}
+
+// set up searches whose buffers will come out of an arena
+void maze_search_init_arena(maze_search* search, maze_arena* arena) {
+	search->arena = arena;
+	search->cells = 0;
+	search->stamp = NULL;
+	search->generation = 0;
+	search->from = NULL;
+	search->cost = NULL;
+	search->queue = NULL;
+	search->heap = NULL;
+	search->heap_capacity = 0;
+	maze_flood_init(&search->flood);
+	maze_fill_init(&search->fill);
+	maze_tree_init(&search->tree);
+	search->flood.arena = arena;
+	search->fill.arena = arena;
+	search->tree.arena = arena;
+	search->num_threads = 1;
+	search->expanded = 0;
+}
+
+// release the per cell buffers of the searches
+static void free_cells(maze_search* search) {
+	maze_release(search->arena, search->stamp);
+	maze_release(search->arena, search->from);
+	maze_release(search->arena, search->cost);
+	maze_release(search->arena, search->queue);
+	search->stamp = NULL;
+	search->from = NULL;
+	search->cost = NULL;
+	search->queue = NULL;
+	search->cells = 0;
+	search->generation = 0;
+}
+
+// release the memory held by the searches
+void maze_search_free(maze_search* search) {
+	free_cells(search);
+	maze_release(search->arena, search->heap);
+	maze_flood_free(&search->flood);
+	maze_fill_free(&search->fill);
+	maze_tree_free(&search->tree);
+	maze_search_init_arena(search, search->arena);
+}
+
+// grow the per cell buffers to fit the grid and start a new query that marks cells with the next
+// marks generations, returns false when out of memory
+static bool start_query(maze_search* search, const maze_grid* grid, uint32_t marks) {
+	size_t cells = (size_t)grid->width * grid->height;
+	if (cells > (size_t)UINT32_MAX) { return false; }
+
+	if (search->cells < cells) {
+		free_cells(search);
+		search->stamp = maze_calloc(search->arena, cells, sizeof(uint32_t));
+		search->from = maze_alloc(search->arena, cells * sizeof(uint8_t));
+		search->cost = maze_alloc(search->arena, cells * sizeof(uint32_t));
+		search->queue = maze_alloc(search->arena, cells * sizeof(uint32_t));
+		if (search->stamp == NULL || search->from == NULL || search->cost == NULL || search->queue == NULL) {
+			free_cells(search);
+			return false;
+		}
+		search->cells = cells;
+	}
+
+	// only clear the stamps on the rare query where the generation wraps around
+	if (search->generation > UINT32_MAX - marks) {
+		memset(search->stamp, 0, search->cells * sizeof(uint32_t));
+		search->generation = 0;
+	}
+	search->generation += marks;
+	search->expanded = 0;
+	return true;
+}
+
+// row major index of the neighbor of a cell in the given direction
+static inline uint32_t neighbor(const maze_grid* grid, uint32_t cell, int direction) {
+	switch (direction) {
+		case north: return cell - grid->width;
+		case east: return cell + 1;
+		case south: return cell + grid->width;
+		default: return cell - 1;
+	}
+}
+
+// follow the from directions back from the goal and write the path out start first
+static bool build_path(const maze_search* search, const maze_grid* grid, uint32_t start, uint32_t goal, maze_path* path) {
+	long long length = 1;
+	for (uint32_t cell = goal; cell != start; ++length) {
+		cell = neighbor(grid, cell, (search->from[cell] + 1) % 4 + 1);
+	}
+	if (!maze_path_reserve(path, length)) { return false; }
+
+	path->length = length;
+	uint32_t cell = goal;
+	for (long long i = length - 1; i >= 0; --i) {
+		path->steps[i].row = cell / grid->width;
+		path->steps[i].col = cell % grid->width;
+		path->steps[i].orientation = search->from[cell];
+		cell = neighbor(grid, cell, (search->from[cell] + 1) % 4 + 1);
+	}
+	return true;
+}
+
+// whether a cell lies inside the grid
+static inline bool inside(const maze_grid* grid, int row, int col) {
+	return row >= 0 && row < grid->height && col >= 0 && col < grid->width;
+}
+
+// breadth first search from the start cell to the goal cell that never enters a cell marked in skip,
+// a row major bitset like maze_fill's dead cells, or any cell when skip is NULL
+static bool breadth_first(maze_search* search, const maze_grid* grid, int start_row, int start_col,
+		int goal_row, int goal_col, const uint64_t* skip, maze_path* path) {
+	if (!inside(grid, start_row, start_col) || !inside(grid, goal_row, goal_col)) { return false; }
+	if (!start_query(search, grid, 1)) { return false; }
+
+	uint32_t start = (uint32_t)start_row * grid->width + start_col;
+	uint32_t goal = (uint32_t)goal_row * grid->width + goal_col;
+	uint32_t generation = search->generation;
+	size_t skip_row_bits = (size_t)grid->words_per_row * 64;
+
+	search->stamp[start] = generation;
+	search->from[start] = south;
+	search->queue[0] = start;
+	size_t head = 0;
+	size_t tail = 1;
+
+	// every cell is queued at most once, so the queue never needs more than one slot per cell
+	while (head < tail) {
+		uint32_t cell = search->queue[head++];
+		++search->expanded;
+		if (cell == goal) { return build_path(search, grid, start, goal, path); }
+
+		int row = cell / grid->width;
+		int col = cell % grid->width;
+		for (int direction = north; direction <= west; ++direction) {
+			if (!maze_can_move(grid, row, col, direction)) { continue; }
+			uint32_t next = neighbor(grid, cell, direction);
+			if (search->stamp[next] == generation) { continue; }
+			if (skip != NULL && maze_test_bit(skip, (next / grid->width) * skip_row_bits + next % grid->width)) { continue; }
+			search->stamp[next] = generation;
+			search->from[next] = direction;
+			search->queue[tail++] = next;
+		}
+	}
+	return false;
+}
+
+// breadth first search from the start cell to the goal cell
+bool maze_search_bfs(maze_search* search, const maze_grid* grid, int start_row, int start_col,
+		int goal_row, int goal_col, maze_path* path) {
+	return breadth_first(search, grid, start_row, start_col, goal_row, goal_col, NULL, path);
+}
+
+// manhattan distance from a cell to the goal
+static inline uint32_t estimate(int row, int col, int goal_row, int goal_col) {
+	return abs(row - goal_row) + abs(col - goal_col);
+}
+
+// add an entry to the A* heap, returns false when out of memory
+static bool heap_push(maze_search* search, size_t* size, uint64_t entry) {
+	if (*size == search->heap_capacity) {
+		size_t capacity = (search->heap_capacity == 0) ? 1024 : 2 * search->heap_capacity;
+		uint64_t* heap = maze_realloc(search->arena, search->heap, search->heap_capacity * sizeof(uint64_t),
+			capacity * sizeof(uint64_t));
+		if (heap == NULL) { return false; }
+		search->heap = heap;
+		search->heap_capacity = capacity;
+	}
+
+	// sift the new entry up from the bottom
+	size_t i = (*size)++;
+	while (i > 0 && search->heap[(i - 1) / 2] > entry) {
+		search->heap[i] = search->heap[(i - 1) / 2];
+		i = (i - 1) / 2;
+	}
+	search->heap[i] = entry;
+	return true;
+}
+
+// take the smallest entry off the A* heap, which must not be empty
+static uint64_t heap_pop(maze_search* search, size_t* size) {
+	uint64_t* heap = search->heap;
+	uint64_t top = heap[0];
+	uint64_t last = heap[--(*size)];
+
+	// sift the last entry down from the top
+	size_t i = 0;
+	while (true) {
+		size_t child = 2 * i + 1;
+		if (child >= *size) { break; }
+		if (child + 1 < *size && heap[child + 1] < heap[child]) { ++child; }
+		if (heap[child] >= last) { break; }
+		heap[i] = heap[child];
+		i = child;
+	}
+	heap[i] = last;
+	return top;
+}
+
+// A* from the start cell to the goal cell with the manhattan distance as the estimate
+bool maze_search_astar(maze_search* search, const maze_grid* grid, int start_row, int start_col,
+		int goal_row, int goal_col, maze_path* path) {
+	if (!inside(grid, start_row, start_col) || !inside(grid, goal_row, goal_col)) { return false; }
+	if (!start_query(search, grid, 1)) { return false; }
+
+	uint32_t start = (uint32_t)start_row * grid->width + start_col;
+	uint32_t goal = (uint32_t)goal_row * grid->width + goal_col;
+	uint32_t generation = search->generation;
+
+	search->stamp[start] = generation;
+	search->from[start] = south;
+	search->cost[start] = 0;
+	size_t size = 0;
+	if (!heap_push(search, &size, (uint64_t)estimate(start_row, start_col, goal_row, goal_col) << 32 | start)) {
+		return false;
+	}
+
+	while (size > 0) {
+		uint64_t entry = heap_pop(search, &size);
+		uint32_t cell = (uint32_t)entry;
+		int row = cell / grid->width;
+		int col = cell % grid->width;
+
+		// skip entries left behind when a cheaper way to their cell was found later
+		if ((entry >> 32) != search->cost[cell] + estimate(row, col, goal_row, goal_col)) { continue; }
+		++search->expanded;
+		if (cell == goal) { return build_path(search, grid, start, goal, path); }
+
+		for (int direction = north; direction <= west; ++direction) {
+			if (!maze_can_move(grid, row, col, direction)) { continue; }
+			uint32_t next = neighbor(grid, cell, direction);
+			uint32_t cost = search->cost[cell] + 1;
+			if (search->stamp[next] == generation && search->cost[next] <= cost) { continue; }
+
+			search->stamp[next] = generation;
+			search->from[next] = direction;
+			search->cost[next] = cost;
+			int next_row = row + (direction == south) - (direction == north);
+			int next_col = col + (direction == east) - (direction == west);
+			uint64_t guess = cost + estimate(next_row, next_col, goal_row, goal_col);
+			if (!heap_push(search, &size, guess << 32 | next)) { return false; }
+		}
+	}
+	return false;
+}
+
+// one end of a bidirectional search. the queue of the start runs up from the front of the queue
+// buffer and the queue of the goal runs down from the back, every cell is queued by at most one
+// of them so they never overlap
+typedef struct {
+	uint32_t* queue;
+	ptrdiff_t step;
+	size_t head;
+	size_t tail;
+	// stamp of the cells reached from this end
+	uint32_t mark;
+} search_end;
+
+static inline uint32_t* queue_slot(search_end* end, size_t i) {
+	return end->queue + (ptrdiff_t)i * end->step;
+}
+
+// take every cell of the current level off the queue of one end and reach their neighbors.
+// neighbors already reached from the other end are where the two meet, the shortest meeting is
+// kept in best with the cell and direction on the start side in meet_cell and meet_direction
+static void expand_level(maze_search* search, const maze_grid* grid, search_end* end, uint32_t other_mark,
+		bool from_goal, long long* best, uint32_t* meet_cell, int* meet_direction) {
+	size_t level_end = end->tail;
+	while (end->head < level_end) {
+		uint32_t cell = *queue_slot(end, end->head++);
+		++search->expanded;
+
+		int row = cell / grid->width;
+		int col = cell % grid->width;
+		for (int direction = north; direction <= west; ++direction) {
+			if (!maze_can_move(grid, row, col, direction)) { continue; }
+			uint32_t next = neighbor(grid, cell, direction);
+			uint32_t stamp = search->stamp[next];
+			if (stamp == end->mark) { continue; }
+
+			if (stamp == other_mark) {
+				long long length = (long long)search->cost[cell] + search->cost[next] + 1;
+				if (*best < 0 || length < *best) {
+					*best = length;
+					*meet_cell = from_goal ? next : cell;
+					*meet_direction = from_goal ? (direction + 1) % 4 + 1 : direction;
+				}
+				continue;
+			}
+
+			search->stamp[next] = end->mark;
+			search->from[next] = direction;
+			search->cost[next] = search->cost[cell] + 1;
+			*queue_slot(end, end->tail++) = next;
+		}
+	}
+}
+
+// write out the path through the meeting of a bidirectional search, following the from directions
+// back to the start on one side and forward to the goal on the other
+static bool join_path(const maze_search* search, const maze_grid* grid, uint32_t meet_cell, int meet_direction,
+		maze_path* path) {
+	uint32_t across = neighbor(grid, meet_cell, meet_direction);
+	long long before = search->cost[meet_cell];
+	long long length = before + search->cost[across] + 2;
+	if (!maze_path_reserve(path, length)) { return false; }
+	path->length = length;
+
+	uint32_t cell = meet_cell;
+	for (long long i = before; i >= 0; --i) {
+		path->steps[i].row = cell / grid->width;
+		path->steps[i].col = cell % grid->width;
+		path->steps[i].orientation = search->from[cell];
+		cell = neighbor(grid, cell, (search->from[cell] + 1) % 4 + 1);
+	}
+
+	// cells on the goal side were entered heading away from the goal, so the path heads the other way
+	cell = across;
+	int orientation = meet_direction;
+	for (long long i = before + 1; i < length; ++i) {
+		path->steps[i].row = cell / grid->width;
+		path->steps[i].col = cell % grid->width;
+		path->steps[i].orientation = orientation;
+		orientation = (search->from[cell] + 1) % 4 + 1;
+		cell = neighbor(grid, cell, orientation);
+	}
+	return true;
+}
+
+// breadth first search from both ends at once until the two meet
+bool maze_search_bidirectional(maze_search* search, const maze_grid* grid, int start_row, int start_col,
+		int goal_row, int goal_col, maze_path* path) {
+	if (!inside(grid, start_row, start_col) || !inside(grid, goal_row, goal_col)) { return false; }
+	if (!start_query(search, grid, 2)) { return false; }
+
+	uint32_t start = (uint32_t)start_row * grid->width + start_col;
+	uint32_t goal = (uint32_t)goal_row * grid->width + goal_col;
+	if (start == goal) {
+		if (!maze_path_reserve(path, 1)) { return false; }
+		path->steps[0].row = start_row;
+		path->steps[0].col = start_col;
+		path->steps[0].orientation = south;
+		path->length = 1;
+		return true;
+	}
+
+	search_end ends[2] = {
+		{ search->queue, 1, 0, 1, search->generation - 1 },
+		{ search->queue + search->cells - 1, -1, 0, 1, search->generation },
+	};
+	uint32_t firsts[2] = { start, goal };
+	for (int i = 0; i < 2; ++i) {
+		search->stamp[firsts[i]] = ends[i].mark;
+		search->from[firsts[i]] = south;
+		search->cost[firsts[i]] = 0;
+		*queue_slot(&ends[i], 0) = firsts[i];
+	}
+
+	// no meeting found in a later level can be shorter than the best of the first level that meets,
+	// so the search stops once that level is finished
+	long long best = -1;
+	uint32_t meet_cell = 0;
+	int meet_direction = 0;
+	while (best < 0) {
+		size_t frontiers[2] = { ends[0].tail - ends[0].head, ends[1].tail - ends[1].head };
+		if (frontiers[0] == 0 || frontiers[1] == 0) { return false; }
+
+		int side = (frontiers[0] <= frontiers[1]) ? 0 : 1;
+		expand_level(search, grid, &ends[side], ends[1 - side].mark, side == 1, &best, &meet_cell, &meet_direction);
+	}
+	return join_path(search, grid, meet_cell, meet_direction, path);
+}
+
+// solve from the entrance at the top left to the exit at the bottom right with one of the MAZE_SOLVER_*
+bool maze_search_solve(maze_search* search, const maze_grid* grid, int solver, maze_path* path) {
+	bool solved;
+	switch (solver) {
+		case MAZE_SOLVER_BFS:
+			return maze_search_bfs(search, grid, 0, 0, grid->height - 1, grid->width - 1, path);
+		case MAZE_SOLVER_ASTAR:
+			return maze_search_astar(search, grid, 0, 0, grid->height - 1, grid->width - 1, path);
+		case MAZE_SOLVER_BIDIRECTIONAL:
+			return maze_search_bidirectional(search, grid, 0, 0, grid->height - 1, grid->width - 1, path);
+		case MAZE_SOLVER_FLOOD:
+			solved = maze_flood_solve(&search->flood, grid, 0, 0, grid->height - 1, grid->width - 1,
+				search->num_threads, path);
+			search->expanded = search->flood.reached_cells;
+			return solved;
+		case MAZE_SOLVER_FILL:
+			solved = maze_fill_solve(&search->fill, grid, search->num_threads, path);
+			search->expanded = (long long)grid->width * grid->height;
+			if (!solved && search->fill.branched) {
+				// a maze with loops leaves more than a corridor, search what the filling left instead.
+				// filled cells are never on the way, so the path is the same as over the whole grid
+				solved = breadth_first(search, grid, 0, 0, grid->height - 1, grid->width - 1, search->fill.dead, path);
+				search->expanded += (long long)grid->width * grid->height;
+			}
+			return solved;
+		case MAZE_SOLVER_TREE:
+			solved = maze_tree_build(&search->tree, grid)
+				&& maze_tree_path(&search->tree, 0, 0, grid->height - 1, grid->width - 1, path);
+			search->expanded = (long long)grid->width * grid->height;
+			return solved;
+		default:
+			solved = solve_maze(grid, path);
+			search->expanded = path->moves;
+			return solved;
+	}
+}
+
+// command line names of the solvers, indexed by MAZE_SOLVER_*
+static const char* solver_names[] = { "wall", "bfs", "astar", "flood", "fill", "tree", "bidir" };
+#define NUM_SOLVERS (int)(sizeof(solver_names) / sizeof(solver_names[0]))
+
+// solver number from its command line name, -1 when unknown
+int maze_solver_from_name(const char* name) {
+	for (int i = 0; i < NUM_SOLVERS; ++i) {
+		if (strcmp(name, solver_names[i]) == 0) { return i; }
+	}
+	return -1;
+}
+
+// command line name of a solver
+const char* maze_solver_name(int solver) {
+	if (solver < 0 || solver >= NUM_SOLVERS) { return "unknown"; }
+	return solver_names[solver];
+}
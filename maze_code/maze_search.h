@@ -0,0 +1,101 @@
+#ifndef _MAZE_SEARCH_H_
+#define _MAZE_SEARCH_H_
+
+#include "maze_grid.h"
+#include "maze_solve.h"
+#include "maze_flood.h"
+#include "maze_fill.h"
+#include "maze_tree.h"
+
+// +----------------------------------------------------------------------+
+// |                                                                      |
+// |                          SHORTEST PATHS                              |
+// |                                                                      |
+// +----------------------------------------------------------------------+
+
+// solvers that can be picked from the command line
+#define MAZE_SOLVER_WALL 0
+#define MAZE_SOLVER_BFS 1
+#define MAZE_SOLVER_ASTAR 2
+#define MAZE_SOLVER_FLOOD 3
+#define MAZE_SOLVER_FILL 4
+#define MAZE_SOLVER_TREE 5
+#define MAZE_SOLVER_BIDIRECTIONAL 6
+
+// +---------------------+
+// |   TYPE DEFINITION   |
+// +---------------------+
+
+// scratch buffers of the shortest path searches, kept between queries so only the first query on
+// the biggest grid allocates. cells are row major indices no matter how the grid is laid out
+typedef struct {
+	size_t cells;
+
+	// a cell has been reached in the current query when its stamp equals generation,
+	// so nothing has to be cleared between queries
+	uint32_t* stamp;
+	uint32_t generation;
+	// direction each reached cell was entered from
+	uint8_t* from;
+	// steps from the start to each reached cell, only used by A* and the bidirectional search
+	uint32_t* cost;
+
+	// FIFO of cells for BFS, the bidirectional search runs a second FIFO down from the end
+	uint32_t* queue;
+	// binary heap of (estimate << 32 | cell) for A*
+	uint64_t* heap;
+	size_t heap_capacity;
+
+	// flood used by MAZE_SOLVER_FLOOD, dead end filling used by MAZE_SOLVER_FILL
+	// and the threads they run on, tree index used by MAZE_SOLVER_TREE
+	maze_flood flood;
+	maze_fill fill;
+	maze_tree tree;
+	int num_threads;
+
+	// cells taken off the queue or heap by the last query. after maze_search_solve it is whatever
+	// the solver does the most work per cell on: cells the wall follower stepped into, cells the
+	// flood reached, or every cell for dead end filling and the tree index
+	long long expanded;
+
+	// arena the buffers come from, NULL when they are on the heap
+	maze_arena* arena;
+} maze_search;
+
+// +---------------+
+// |   FUNCTIONS   |
+// +---------------+
+
+// set up searches that own no memory yet
+void maze_search_init(maze_search* search);
+// set up searches whose buffers, those of the flood, filling and tree index included, will come out of an arena
+void maze_search_init_arena(maze_search* search, maze_arena* arena);
+// release the memory held by the searches
+void maze_search_free(maze_search* search);
+
+// breadth first search from the start cell to the goal cell, the shortest path is written to path.
+// the start cell is marked as entered heading south like the entrance in solve_maze.
+// returns false when out of memory or when the goal can't be reached
+bool maze_search_bfs(maze_search* search, const maze_grid* grid, int start_row, int start_col,
+	int goal_row, int goal_col, maze_path* path);
+
+// A* with the manhattan distance to the goal as the estimate, same results as maze_search_bfs
+// but it only expands the cells that look like they lead toward the goal
+bool maze_search_astar(maze_search* search, const maze_grid* grid, int start_row, int start_col,
+	int goal_row, int goal_col, maze_path* path);
+
+// breadth first search from both ends at once, one whole level at a time from whichever end has
+// the smaller frontier, until the two meet. same results as maze_search_bfs, usually with fewer
+// cells expanded since neither end has to search past the middle of the path
+bool maze_search_bidirectional(maze_search* search, const maze_grid* grid, int start_row, int start_col,
+	int goal_row, int goal_col, maze_path* path);
+
+// solve from the entrance at the top left to the exit at the bottom right with one of the MAZE_SOLVER_*
+bool maze_search_solve(maze_search* search, const maze_grid* grid, int solver, maze_path* path);
+
+// solver number from its command line name, -1 when unknown
+int maze_solver_from_name(const char* name);
+// command line name of a solver
+const char* maze_solver_name(int solver);
+
+#endif
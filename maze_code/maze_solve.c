@@ -0,0 +1,122 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "maze_solve.h"
+
+// +---------------+
+// |   FUNCTIONS   |
+// +---------------+
+
+// set up an empty path that owns no memory yet
+void maze_path_init(maze_path* path) {
+	maze_path_init_arena(path, NULL);
+}
+
+// set up an empty path whose buffers will come out of an arena
+void maze_path_init_arena(maze_path* path, maze_arena* arena) {
+	path->arena = arena;
+	path->steps = NULL;
+	path->length = 0;
+	path->capacity = 0;
+	path->moves = 0;
+	path->last_seen = NULL;
+	path->last_seen_cells = 0;
+}
+
+// release the memory held by a path
+void maze_path_free(maze_path* path) {
+	maze_release(path->arena, path->steps);
+	maze_release(path->arena, path->last_seen);
+	maze_path_init_arena(path, path->arena);
+}
+
+// make room for at least length steps, returns false when out of memory
+bool maze_path_reserve(maze_path* path, long long length) {
+	if (length <= path->capacity) { return true; }
+
+	long long capacity = (path->capacity == 0) ? 1024 : path->capacity;
+	while (capacity < length) { capacity *= 2; }
+	maze_step* steps = maze_realloc(path->arena, path->steps, path->capacity * sizeof(maze_step),
+		capacity * sizeof(maze_step));
+	if (steps == NULL) { return false; }
+	path->steps = steps;
+	path->capacity = capacity;
+	return true;
+}
+
+// left hand rule walk from the entrance to the exit, removing every loop as soon as the walk closes it
+bool solve_maze(const maze_grid* grid, maze_path* path) {
+
+	// the path never holds a cell twice, so every index fits in the last seen table
+	size_t cells = (size_t)grid->width * grid->height;
+	if (cells > (size_t)UINT32_MAX) { return false; }
+	if (path->last_seen_cells < cells) {
+		maze_release(path->arena, path->last_seen);
+		// zeroed the first time so stale entries are always readable, they are checked before use
+		path->last_seen = maze_calloc(path->arena, cells, sizeof(uint32_t));
+		path->last_seen_cells = (path->last_seen == NULL) ? 0 : cells;
+		if (path->last_seen == NULL) { return false; }
+	}
+	if (!maze_path_reserve(path, 1)) { return false; }
+
+	// starting data for entrance at the north west corner of maze going down
+	int row = 0;
+	int col = 0;
+	int orientation = south;
+
+	// IMPORTANT: orientation notates the orientation of the camera as it enters the cell
+	path->steps[0].row = row;
+	path->steps[0].col = col;
+	path->steps[0].orientation = orientation;
+	path->last_seen[0] = 0;
+	path->length = 1;
+	path->moves = 0;
+
+	// generate list of directions to exit of maze
+	while (row != grid->height - 1 || col != grid->width - 1) {
+
+		// set orientation to look left relative to current position
+		orientation = (orientation + 6) % 4 + 1;
+
+		// find next valid position, starting with previously mentioned left turn then turning right repeatedly
+		while (true) {
+			if (orientation == north) {
+				if (maze_has_wall(grid, row, col, north)) { orientation = orientation % 4 + 1; }
+				else { row -= 1; break; }
+			}
+			else if (orientation == east) {
+				if (maze_has_wall(grid, row, col, east)) { orientation = orientation % 4 + 1; }
+				else { col += 1; break; }
+			}
+			else if (orientation == south) {
+				if (maze_has_wall(grid, row, col, south)) { orientation = orientation % 4 + 1; }
+				else { row += 1; break; }
+			}
+			else if (orientation == west) {
+				if (maze_has_wall(grid, row, col, west)) { orientation = orientation % 4 + 1; }
+				else { col -= 1; break; }
+			}
+		}
+
+		++path->moves;
+
+		// when the walk comes back to a cell still on the path, everything after that cell was a
+		// dead end, so cut it off and keep the direction the cell was first entered from
+		size_t cell = (size_t)row * grid->width + col;
+		uint32_t seen = path->last_seen[cell];
+		if (seen < path->length && path->steps[seen].row == row && path->steps[seen].col == col) {
+			path->length = (long long)seen + 1;
+			continue;
+		}
+
+		// otherwise add the cell to the end of the path
+		if (!maze_path_reserve(path, path->length + 1)) { return false; }
+		maze_step* step = &path->steps[path->length];
+		step->row = row;
+		step->col = col;
+		step->orientation = orientation;
+		path->last_seen[cell] = (uint32_t)path->length;
+		++path->length;
+	}
+
+	return true;
+}
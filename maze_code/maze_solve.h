@@ -0,0 +1,59 @@
+#ifndef _MAZE_SOLVE_H_
+#define _MAZE_SOLVE_H_
+
+#include "maze_grid.h"
+
+// +----------------------------------------------------------------------+
+// |                                                                      |
+// |                             SOLVING                                  |
+// |                                                                      |
+// +----------------------------------------------------------------------+
+
+// +---------------------+
+// |   TYPE DEFINITION   |
+// +---------------------+
+
+// one cell of a path and the direction it was entered from
+typedef struct {
+	int row;
+	int col;
+	int orientation;
+} maze_step;
+
+// flat array of steps from the entrance to the exit. the buffers are kept between solves so
+// solving many mazes only allocates when a path or grid is bigger than any before it
+typedef struct {
+	maze_step* steps;
+	long long length;
+	long long capacity;
+
+	// cells the wall follower stepped into while solving, dead ends and backtracking included
+	long long moves;
+
+	// for every cell, the index in steps it was last pushed at. only trusted when the step at
+	// that index is still inside the path and is that cell, so it never has to be cleared
+	uint32_t* last_seen;
+	size_t last_seen_cells;
+
+	// arena the buffers come from, NULL when they are on the heap
+	maze_arena* arena;
+} maze_path;
+
+// +---------------+
+// |   FUNCTIONS   |
+// +---------------+
+
+// set up an empty path that owns no memory yet
+void maze_path_init(maze_path* path);
+// set up an empty path whose buffers will come out of an arena
+void maze_path_init_arena(maze_path* path, maze_arena* arena);
+// release the memory held by a path
+void maze_path_free(maze_path* path);
+// make room for at least length steps, returns false when out of memory
+bool maze_path_reserve(maze_path* path, long long length);
+
+// left hand rule walk from the entrance at the top left to the exit at the bottom right, with every
+// loop of the walk removed so only the shortest path is left. returns false when out of memory
+bool solve_maze(const maze_grid* grid, maze_path* path);
+
+#endif
@@ -0,0 +1,271 @@
+#include <stdlib.h>
+#include <string.h>
+#include "maze_stream.h"
+
+// +---------------+
+// |   FUNCTIONS   |
+// +---------------+
+
+// root of a set in the per-row union find, halving the path on the way up
+static int find_set(int* parent, int x) {
+	while (parent[x] != x) {
+		parent[x] = parent[parent[x]];
+		x = parent[x];
+	}
+	return x;
+}
+
+// fair coin flip, drawing 64 flips at a time from the generator
+static inline bool flip_coin(maze_rng* rng, uint64_t* coins, int* coins_left) {
+	if (*coins_left == 0) {
+		*coins = maze_rng_next(rng);
+		*coins_left = 64;
+	}
+	bool result = *coins & 1;
+	*coins >>= 1;
+	--*coins_left;
+	return result;
+}
+
+// Eller's algorithm, every column of the current row belongs to a set of cells that are already
+// connected through the rows above. neighboring cells of different sets are randomly joined, then
+// every set gets at least one passage down so no set is cut off from the rest of the maze.
+// the last row joins every remaining set together
+bool generate_maze_eller(int width, long long height, maze_rng* rng, maze_row_sink sink, void* sink_data) {
+	size_t words = ((size_t)width + 63) / 64;
+
+	// set of each column, labels are always kept below width
+	int* label = malloc(width * sizeof(int));
+	// union find over the labels of the current row
+	int* parent = malloc(width * sizeof(int));
+	// label of each set in the next row
+	int* remap = malloc(width * sizeof(int));
+	// number of cells seen so far of each set without a passage down and the one picked to open
+	int* count = malloc(width * sizeof(int));
+	int* pick = malloc(width * sizeof(int));
+	bool* has_down = malloc(width * sizeof(bool));
+	// north, south and east wall bitsets of the current row
+	uint64_t* walls = malloc(3 * words * sizeof(uint64_t));
+
+	bool ok = label && parent && remap && count && pick && has_down && walls;
+
+	maze_row current;
+	current.width = width;
+	current.words_per_row = words;
+	current.height = height;
+	current.north_walls = walls;
+	current.south_walls = walls + words;
+	current.east_walls = walls + 2 * words;
+
+	uint64_t* north_walls = walls;
+	uint64_t* south_walls = walls + words;
+	uint64_t* east_walls = walls + 2 * words;
+
+	uint64_t coins = 0;
+	int coins_left = 0;
+
+	if (ok) {
+		// every cell of the first row starts in its own set, entrance in the first column
+		for (int col = 0; col < width; ++col) {
+			label[col] = col;
+		}
+		memset(north_walls, 0xff, words * sizeof(uint64_t));
+		maze_clear_bit(north_walls, 0);
+	}
+
+	for (long long row = 0; ok && row < height; ++row) {
+		bool last_row = (row == height - 1);
+
+		memset(south_walls, 0xff, words * sizeof(uint64_t));
+		memset(east_walls, 0xff, words * sizeof(uint64_t));
+		for (int i = 0; i < width; ++i) {
+			parent[i] = i;
+		}
+
+		// randomly join neighboring cells of different sets, the last row joins all of them
+		for (int col = 0; col < width - 1; ++col) {
+			int a = find_set(parent, label[col]);
+			int b = find_set(parent, label[col + 1]);
+			if (a != b && (last_row || flip_coin(rng, &coins, &coins_left))) {
+				maze_clear_bit(east_walls, col);
+				parent[b] = a;
+			}
+		}
+
+		// from here on each column only needs the root of its set
+		for (int col = 0; col < width; ++col) {
+			label[col] = find_set(parent, label[col]);
+		}
+
+		if (last_row) {
+			// add exit point at bottom right of maze
+			maze_clear_bit(south_walls, width - 1);
+		} else {
+			// random passages down
+			for (int i = 0; i < width; ++i) {
+				count[i] = 0;
+				has_down[i] = false;
+			}
+			for (int col = 0; col < width; ++col) {
+				if (flip_coin(rng, &coins, &coins_left)) {
+					maze_clear_bit(south_walls, col);
+					has_down[label[col]] = true;
+				}
+			}
+			// pick a cell uniformly from each set that got no passage down and open it, so
+			// every set continues into the next row
+			for (int col = 0; col < width; ++col) {
+				int root = label[col];
+				if (!has_down[root]) {
+					++count[root];
+					if (count[root] == 1 || maze_rng_below(rng, count[root]) == 0) {
+						pick[root] = col;
+					}
+				}
+			}
+			for (int col = 0; col < width; ++col) {
+				int root = label[col];
+				if (!has_down[root]) {
+					maze_clear_bit(south_walls, pick[root]);
+					has_down[root] = true;
+				}
+			}
+		}
+
+		current.row = row;
+		if (!sink(&current, sink_data)) {
+			ok = false;
+			break;
+		}
+
+		// cells below a passage keep their set, every other cell starts a new one
+		for (int i = 0; i < width; ++i) {
+			remap[i] = -1;
+		}
+		int next_label = 0;
+		for (int col = 0; col < width; ++col) {
+			if (!maze_test_bit(south_walls, col)) {
+				int root = label[col];
+				if (remap[root] < 0) {
+					remap[root] = next_label++;
+				}
+				label[col] = remap[root];
+			} else {
+				label[col] = next_label++;
+			}
+		}
+		memcpy(north_walls, south_walls, words * sizeof(uint64_t));
+	}
+
+	free(label);
+	free(parent);
+	free(remap);
+	free(count);
+	free(pick);
+	free(has_down);
+	free(walls);
+	return ok;
+}
+
+// +-----------+
+// |   SINKS   |
+// +-----------+
+
+// copy each row into a maze_grid of matching dimensions, sink_data is the maze_grid*
+bool maze_row_sink_grid(const maze_row* row, void* sink_data) {
+	maze_grid* grid = sink_data;
+	if (grid->width != row->width || row->row >= grid->height) {
+		return false;
+	}
+
+	if (row->row == 0) {
+		grid->entrance_col = -1;
+		for (int col = 0; col < row->width; ++col) {
+			if (!maze_test_bit(row->north_walls, col)) {
+				grid->entrance_col = col;
+				break;
+			}
+		}
+	}
+
+	maze_grid_set_row(grid, row->row, row->south_walls, row->east_walls);
+	return true;
+}
+
+// print each row the same way as print_maze(), sink_data is the FILE*
+bool maze_row_sink_print(const maze_row* row, void* sink_data) {
+	FILE* out = sink_data;
+
+	// first row
+	for (int col = 0; col < row->width; ++col) {
+		fputs(maze_test_bit(row->north_walls, col) ? "+++++" : "+   +", out);
+	}
+	fputc('\n', out);
+	// second row
+	for (int col = 0; col < row->width; ++col) {
+		bool west_wall = (col == 0) || maze_test_bit(row->east_walls, col - 1);
+		fputc(west_wall ? '|' : ' ', out);
+		fputs("   ", out);
+		fputc(maze_test_bit(row->east_walls, col) ? '|' : ' ', out);
+	}
+	fputc('\n', out);
+	// third row
+	for (int col = 0; col < row->width; ++col) {
+		fputs(maze_test_bit(row->south_walls, col) ? "+++++" : "+   +", out);
+	}
+	fputc('\n', out);
+
+	return !ferror(out);
+}
+
+// write the south and east wall bitset of each row as raw 64 bit words, sink_data is the FILE*
+bool maze_row_sink_raw(const maze_row* row, void* sink_data) {
+	FILE* out = sink_data;
+	return fwrite(row->south_walls, sizeof(uint64_t), row->words_per_row, out) == row->words_per_row
+		&& fwrite(row->east_walls, sizeof(uint64_t), row->words_per_row, out) == row->words_per_row;
+}
+
+// hand every row of a finished grid to a sink in order, returns false when the sink stopped
+bool maze_grid_stream(const maze_grid* grid, maze_row_sink sink, void* sink_data) {
+	size_t words = grid->words_per_row;
+
+	// north border of the first row, only open at the entrance, followed by row buffers for
+	// grids that don't keep their rows contiguous
+	uint64_t* buffers = malloc(5 * words * sizeof(uint64_t));
+	if (buffers == NULL) { return false; }
+	uint64_t* border = buffers;
+	uint64_t* south_walls[2] = { buffers + words, buffers + 2 * words };
+	uint64_t* east_walls = buffers + 3 * words;
+	memset(border, 0xff, words * sizeof(uint64_t));
+	if (grid->entrance_col >= 0) { maze_clear_bit(border, grid->entrance_col); }
+
+	maze_row current;
+	current.width = grid->width;
+	current.words_per_row = words;
+	current.height = grid->height;
+
+	bool ok = true;
+	for (int row = 0; ok && row < grid->height; ++row) {
+		current.row = row;
+		if (grid->layout == MAZE_LAYOUT_ROW_MAJOR) {
+			size_t offset = (size_t)row * words;
+			current.north_walls = (row == 0) ? border : grid->south_walls + offset - words;
+			current.south_walls = grid->south_walls + offset;
+			current.east_walls = grid->east_walls + offset;
+		} else {
+			maze_grid_get_row(grid, row, south_walls[row & 1], east_walls);
+			current.north_walls = (row == 0) ? border : south_walls[(row + 1) & 1];
+			current.south_walls = south_walls[row & 1];
+			current.east_walls = east_walls;
+		}
+		ok = sink(&current, sink_data);
+	}
+
+	free(buffers);
+	return ok;
+}
+
+// print a whole grid with maze_row_sink_print
+bool maze_grid_print(const maze_grid* grid, FILE* out) {
+	return maze_grid_stream(grid, maze_row_sink_print, out);
+}
@@ -0,0 +1,63 @@
+#ifndef _MAZE_STREAM_H_
+#define _MAZE_STREAM_H_
+
+#include <stdio.h>
+#include "maze_grid.h"
+#include "maze_rng.h"
+
+// +----------------------------------------------------------------------+
+// |                                                                      |
+// |                       STREAMED GENERATION                            |
+// |                                                                      |
+// +----------------------------------------------------------------------+
+
+// +---------------------+
+// |   TYPE DEFINITION   |
+// +---------------------+
+
+// one finished row of a streamed maze, laid out like a single row of a maze_grid bitset.
+// north_walls is the south wall bitset of the row above, or the north border for row 0
+typedef struct {
+	int width;
+	size_t words_per_row;
+	long long row;
+	long long height;
+
+	const uint64_t* north_walls;
+	const uint64_t* south_walls;
+	const uint64_t* east_walls;
+} maze_row;
+
+// called once per finished row in order, return false to stop generation
+typedef bool (*maze_row_sink)(const maze_row* row, void* sink_data);
+
+// +---------------+
+// |   FUNCTIONS   |
+// +---------------+
+
+// Eller's algorithm, builds the maze one row at a time and hands every finished row to the sink.
+// only O(width) memory is kept no matter how many rows are generated. the entrance is in the
+// north border of the first column and the exit in the south border of the last column.
+// returns false when out of memory or when the sink stopped generation
+bool generate_maze_eller(int width, long long height, maze_rng* rng, maze_row_sink sink, void* sink_data);
+
+// +-----------+
+// |   SINKS   |
+// +-----------+
+
+// copy each row into a maze_grid of matching dimensions, sink_data is the maze_grid*
+bool maze_row_sink_grid(const maze_row* row, void* sink_data);
+
+// print each row the same way as print_maze(), sink_data is the FILE*
+bool maze_row_sink_print(const maze_row* row, void* sink_data);
+
+// write the south and east wall bitset of each row as raw 64 bit words, sink_data is the FILE*
+bool maze_row_sink_raw(const maze_row* row, void* sink_data);
+
+// hand every row of a finished grid to a sink in order, returns false when the sink stopped
+bool maze_grid_stream(const maze_grid* grid, maze_row_sink sink, void* sink_data);
+
+// print a whole grid with maze_row_sink_print
+bool maze_grid_print(const maze_grid* grid, FILE* out);
+
+#endif
@@ -0,0 +1,51 @@
+#include <stdlib.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "maze_thread.h"
+
+// shared state of the workers of one parallel loop
+typedef struct {
+	int count;
+	maze_task task;
+	void* task_data;
+	atomic_int next_index;
+} parallel_job;
+
+// worker that keeps taking the next index until every index is done
+static void* parallel_worker(void* arg) {
+	parallel_job* job = arg;
+	while (1) {
+		int index = atomic_fetch_add(&job->next_index, 1);
+		if (index >= job->count) { break; }
+		job->task(index, job->task_data);
+	}
+	return NULL;
+}
+
+// run task for every index in [0, count) on up to num_threads threads, the calling thread included
+void maze_parallel_for(int count, int num_threads, maze_task task, void* task_data) {
+	parallel_job job;
+	job.count = count;
+	job.task = task;
+	job.task_data = task_data;
+	atomic_init(&job.next_index, 0);
+
+	if (num_threads > count) { num_threads = count; }
+
+	// when threads can't be made the calling thread simply does all of the work
+	pthread_t* threads = NULL;
+	int started = 0;
+	if (num_threads > 1) {
+		threads = malloc((num_threads - 1) * sizeof(pthread_t));
+	}
+	for (int i = 1; threads != NULL && i < num_threads; ++i) {
+		if (pthread_create(&threads[started], NULL, parallel_worker, &job) == 0) {
+			++started;
+		}
+	}
+	parallel_worker(&job);
+	for (int i = 0; i < started; ++i) {
+		pthread_join(threads[i], NULL);
+	}
+	free(threads);
+}
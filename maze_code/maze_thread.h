@@ -0,0 +1,21 @@
+#ifndef _MAZE_THREAD_H_
+#define _MAZE_THREAD_H_
+
+// +----------------------------------------------------------------------+
+// |                                                                      |
+// |                             THREADS                                  |
+// |                                                                      |
+// +----------------------------------------------------------------------+
+
+// one unit of work, called once for every index of a parallel loop
+typedef void (*maze_task)(int index, void* task_data);
+
+// +---------------+
+// |   FUNCTIONS   |
+// +---------------+
+
+// run task for every index in [0, count) on up to num_threads threads, the calling thread
+// included. indices are handed out one at a time, so uneven tasks still balance out
+void maze_parallel_for(int count, int num_threads, maze_task task, void* task_data);
+
+#endif
@@ -0,0 +1,268 @@
+#include <stdlib.h>
+#include <string.h>
+#include "maze_tree.h"
+#include "maze_thread.h"
+
+// queries handed to a thread at a time by maze_tree_distances
+#define QUERY_CHUNK 65536
+
+// +---------------+
+// |   FUNCTIONS   |
+// +---------------+
+
+// set up an index that owns no memory yet
+void maze_tree_init(maze_tree* tree) {
+	tree->width = 0;
+	tree->height = 0;
+	tree->cells = 0;
+	tree->order = NULL;
+	tree->depths = NULL;
+	tree->parent = NULL;
+	tree->masks = NULL;
+	tree->sparse = NULL;
+	tree->num_blocks = 0;
+	tree->levels = 0;
+	tree->arena = NULL;
+}
+
+// release the memory held by an index
+void maze_tree_free(maze_tree* tree) {
+	maze_release(tree->arena, tree->order);
+	maze_release(tree->arena, tree->depths);
+	maze_release(tree->arena, tree->parent);
+	maze_release(tree->arena, tree->masks);
+	maze_release(tree->arena, tree->sparse);
+	maze_arena* arena = tree->arena;
+	maze_tree_init(tree);
+	tree->arena = arena;
+}
+
+// row major index of the neighbor of a cell in the given direction
+static inline uint32_t neighbor(const maze_tree* tree, uint32_t cell, int direction) {
+	switch (direction) {
+		case north: return cell - tree->width;
+		case east: return cell + 1;
+		case south: return cell + tree->width;
+		default: return cell - 1;
+	}
+}
+
+// number the cells in depth first order from the top left cell, recording the depth and parent of
+// each. a maze with a loop reaches some cell twice and a maze in pieces never reaches some cell,
+// either way it isn't a tree and false is returned
+static bool number_cells(maze_tree* tree, const maze_grid* grid, uint32_t* stack) {
+	memset(tree->order, 0xff, tree->cells * sizeof(uint32_t));
+	size_t top = 0;
+	size_t pushed = 1;
+	uint32_t position = 0;
+	stack[top++] = 0;
+	tree->parent[0] = 0;
+
+	// children are pushed together and popped one subtree at a time, so every subtree ends up
+	// as one contiguous run of positions
+	while (top > 0) {
+		uint32_t cell = stack[--top];
+		if (tree->order[cell] != UINT32_MAX) { return false; }
+		tree->order[cell] = position;
+		tree->depths[position] = (cell == 0) ? 0 : tree->depths[tree->order[neighbor(tree, cell, tree->parent[cell])]] + 1;
+		++position;
+
+		int row = cell / tree->width;
+		int col = cell % tree->width;
+		for (int direction = north; direction <= west; ++direction) {
+			if (direction == tree->parent[cell] || !maze_can_move(grid, row, col, direction)) { continue; }
+			// a tree has one edge less than it has cells, any more and the stack could overflow
+			if (pushed++ == tree->cells) { return false; }
+			uint32_t next = neighbor(tree, cell, direction);
+			tree->parent[next] = (direction + 1) % 4 + 1;
+			stack[top++] = next;
+		}
+	}
+	return position == tree->cells;
+}
+
+// fill in the in block masks and the sparse table of block minimums
+static void index_depths(maze_tree* tree) {
+	for (size_t block = 0; block < tree->num_blocks; ++block) {
+		size_t first = block * MAZE_TREE_BLOCK;
+		size_t end = first + MAZE_TREE_BLOCK;
+		if (end > tree->cells) { end = tree->cells; }
+
+		// bit j of a mask is set when the depth at first + j is smaller than every depth after it,
+		// so the lowest bit at or above the start of a range is the minimum of that range
+		uint64_t smaller = 0;
+		uint32_t minimum = UINT32_MAX;
+		for (size_t i = first; i < end; ++i) {
+			uint32_t depth = tree->depths[i];
+			while (smaller != 0 && tree->depths[first + 63 - __builtin_clzll(smaller)] >= depth) {
+				smaller &= ~((uint64_t)1 << (63 - __builtin_clzll(smaller)));
+			}
+			smaller |= (uint64_t)1 << (i - first);
+			tree->masks[i] = smaller;
+			if (depth < minimum) { minimum = depth; }
+		}
+		tree->sparse[block] = minimum;
+	}
+
+	for (int level = 1; level < tree->levels; ++level) {
+		const uint32_t* below = tree->sparse + (level - 1) * tree->num_blocks;
+		uint32_t* here = tree->sparse + level * tree->num_blocks;
+		size_t half = (size_t)1 << (level - 1);
+		for (size_t block = 0; block + 2 * half <= tree->num_blocks; ++block) {
+			here[block] = (below[block] < below[block + half]) ? below[block] : below[block + half];
+		}
+	}
+}
+
+// build the index of a maze, returns false when out of memory or when the maze isn't a spanning tree
+bool maze_tree_build(maze_tree* tree, const maze_grid* grid) {
+	size_t cells = (size_t)grid->width * grid->height;
+	if (cells > (size_t)UINT32_MAX) { return false; }
+
+	if (tree->cells != cells) {
+		maze_tree_free(tree);
+		tree->num_blocks = (cells + MAZE_TREE_BLOCK - 1) / MAZE_TREE_BLOCK;
+		tree->levels = 1;
+		while (((size_t)1 << tree->levels) <= tree->num_blocks) { ++tree->levels; }
+
+		tree->order = maze_alloc(tree->arena, cells * sizeof(uint32_t));
+		tree->depths = maze_alloc(tree->arena, cells * sizeof(uint32_t));
+		tree->parent = maze_alloc(tree->arena, cells * sizeof(uint8_t));
+		tree->masks = maze_alloc(tree->arena, cells * sizeof(uint64_t));
+		tree->sparse = maze_alloc(tree->arena, tree->levels * tree->num_blocks * sizeof(uint32_t));
+		if (tree->order == NULL || tree->depths == NULL || tree->parent == NULL
+				|| tree->masks == NULL || tree->sparse == NULL) {
+			maze_tree_free(tree);
+			return false;
+		}
+		tree->cells = cells;
+	}
+	tree->width = grid->width;
+	tree->height = grid->height;
+
+	// the masks aren't filled in yet, so borrow them as the depth first stack
+	if (!number_cells(tree, grid, (uint32_t*)tree->masks)) { return false; }
+	index_depths(tree);
+	return true;
+}
+
+// smallest depth at positions first to last of the depth first order, both inside one block
+static inline uint32_t block_minimum(const maze_tree* tree, size_t first, size_t last) {
+	uint64_t smaller = tree->masks[last] & (~(uint64_t)0 << (first % MAZE_TREE_BLOCK));
+	return tree->depths[last - last % MAZE_TREE_BLOCK + __builtin_ctzll(smaller)];
+}
+
+// smallest depth at positions first to last of the depth first order
+static inline uint32_t range_minimum(const maze_tree* tree, size_t first, size_t last) {
+	size_t first_block = first / MAZE_TREE_BLOCK;
+	size_t last_block = last / MAZE_TREE_BLOCK;
+	if (first_block == last_block) { return block_minimum(tree, first, last); }
+
+	uint32_t minimum = block_minimum(tree, first, first_block * MAZE_TREE_BLOCK + MAZE_TREE_BLOCK - 1);
+	uint32_t tail = block_minimum(tree, last_block * MAZE_TREE_BLOCK, last);
+	if (tail < minimum) { minimum = tail; }
+
+	// the whole blocks in between are covered by two overlapping runs of the sparse table
+	if (first_block + 1 < last_block) {
+		size_t blocks = last_block - first_block - 1;
+		int level = 63 - __builtin_clzll(blocks);
+		const uint32_t* runs = tree->sparse + level * tree->num_blocks;
+		uint32_t left = runs[first_block + 1];
+		uint32_t right = runs[last_block - ((size_t)1 << level)];
+		if (left < minimum) { minimum = left; }
+		if (right < minimum) { minimum = right; }
+	}
+	return minimum;
+}
+
+// depth of the deepest common ancestor of two cells
+static inline uint32_t ancestor_depth(const maze_tree* tree, uint32_t start, uint32_t goal) {
+	size_t first = tree->order[start];
+	size_t last = tree->order[goal];
+	if (first == last) { return tree->depths[first]; }
+	if (first > last) {
+		size_t swap = first;
+		first = last;
+		last = swap;
+	}
+
+	// the shallowest cell after the first one up to the last one is a child of their common ancestor
+	return range_minimum(tree, first + 1, last) - 1;
+}
+
+// depth of a row major cell
+static inline uint32_t depth_of(const maze_tree* tree, uint32_t cell) {
+	return tree->depths[tree->order[cell]];
+}
+
+// number of steps between two cells
+uint32_t maze_tree_distance(const maze_tree* tree, int start_row, int start_col, int goal_row, int goal_col) {
+	uint32_t start = (uint32_t)start_row * tree->width + start_col;
+	uint32_t goal = (uint32_t)goal_row * tree->width + goal_col;
+	return depth_of(tree, start) + depth_of(tree, goal) - 2 * ancestor_depth(tree, start, goal);
+}
+
+// the path between two cells in O(path length), the start cell is marked as entered heading south
+// like the entrance in solve_maze. returns false when out of memory
+bool maze_tree_path(const maze_tree* tree, int start_row, int start_col, int goal_row, int goal_col, maze_path* path) {
+	if (start_row < 0 || start_row >= tree->height || start_col < 0 || start_col >= tree->width) { return false; }
+	if (goal_row < 0 || goal_row >= tree->height || goal_col < 0 || goal_col >= tree->width) { return false; }
+
+	uint32_t start = (uint32_t)start_row * tree->width + start_col;
+	uint32_t goal = (uint32_t)goal_row * tree->width + goal_col;
+	uint32_t top = ancestor_depth(tree, start, goal);
+	uint32_t up = depth_of(tree, start) - top;
+	uint32_t down = depth_of(tree, goal) - top;
+	if (!maze_path_reserve(path, (long long)up + down + 1)) { return false; }
+	path->length = (long long)up + down + 1;
+
+	// climb from the start to the common ancestor, each step heading the way of the parent
+	uint32_t cell = start;
+	int orientation = south;
+	for (uint32_t i = 0; i <= up; ++i) {
+		path->steps[i].row = cell / tree->width;
+		path->steps[i].col = cell % tree->width;
+		path->steps[i].orientation = orientation;
+		orientation = tree->parent[cell];
+		cell = neighbor(tree, cell, orientation);
+	}
+
+	// then climb from the goal and write the steps back to front, each heading away from the parent
+	cell = goal;
+	for (long long i = path->length - 1; i > up; --i) {
+		path->steps[i].row = cell / tree->width;
+		path->steps[i].col = cell % tree->width;
+		path->steps[i].orientation = (tree->parent[cell] + 1) % 4 + 1;
+		cell = neighbor(tree, cell, tree->parent[cell]);
+	}
+	return true;
+}
+
+// a batch of queries shared by the threads of maze_tree_distances
+typedef struct {
+	const maze_tree* tree;
+	const maze_query* queries;
+	long long count;
+	uint32_t* distances;
+} query_job;
+
+// answer one chunk of a batch
+static void answer_chunk(int index, void* task_data) {
+	query_job* job = task_data;
+	long long first = (long long)index * QUERY_CHUNK;
+	long long end = first + QUERY_CHUNK;
+	if (end > job->count) { end = job->count; }
+
+	for (long long i = first; i < end; ++i) {
+		const maze_query* query = job->queries + i;
+		job->distances[i] = maze_tree_distance(job->tree, query->start_row, query->start_col,
+			query->goal_row, query->goal_col);
+	}
+}
+
+// answer count distance queries on num_threads threads, distances[i] is the answer to queries[i]
+void maze_tree_distances(const maze_tree* tree, const maze_query* queries, long long count,
+		uint32_t* distances, int num_threads) {
+	query_job job = { tree, queries, count, distances };
+	maze_parallel_for((count + QUERY_CHUNK - 1) / QUERY_CHUNK, num_threads, answer_chunk, &job);
+}
@@ -0,0 +1,82 @@
+#ifndef _MAZE_TREE_H_
+#define _MAZE_TREE_H_
+
+#include "maze_grid.h"
+#include "maze_solve.h"
+
+// +----------------------------------------------------------------------+
+// |                                                                      |
+// |                            TREE INDEX                                |
+// |                                                                      |
+// +----------------------------------------------------------------------+
+
+// a perfect maze is a spanning tree of its cells. the index roots that tree at the entrance and lists
+// the cells in depth first order, where every subtree is one contiguous run. the deepest common
+// ancestor of two cells is then one shallower than the shallowest cell strictly after the first
+// of them up to the second, so a range minimum over the depths in that order answers any distance
+// in O(1). range minimums use a sparse table over blocks of 64 cells, and inside a block a bit
+// mask per cell of the cells still smaller than everything after them
+
+// cells in each block of the range minimum index
+#define MAZE_TREE_BLOCK 64
+
+// +---------------------+
+// |   TYPE DEFINITION   |
+// +---------------------+
+
+// one distance or path query between two cells
+typedef struct {
+	int start_row;
+	int start_col;
+	int goal_row;
+	int goal_col;
+} maze_query;
+
+// index of one maze, built once and then only read, so any number of threads can query it
+typedef struct {
+	int width;
+	int height;
+	size_t cells;
+
+	// position of every row major cell in depth first order
+	uint32_t* order;
+	// depth of the cell at every position of the depth first order
+	uint32_t* depths;
+	// direction from every row major cell to its parent, 0 for the root
+	uint8_t* parent;
+
+	// for every position, the positions in its block up to it that are smaller than all after them
+	uint64_t* masks;
+	// minimum depth of every block, then of every run of 2, 4, 8 ... blocks
+	uint32_t* sparse;
+	size_t num_blocks;
+	int levels;
+
+	// arena the buffers come from, NULL when they are on the heap
+	maze_arena* arena;
+} maze_tree;
+
+// +---------------+
+// |   FUNCTIONS   |
+// +---------------+
+
+// set up an index that owns no memory yet
+void maze_tree_init(maze_tree* tree);
+// release the memory held by an index
+void maze_tree_free(maze_tree* tree);
+
+// build the index of a maze, returns false when out of memory or when the maze isn't a spanning tree
+bool maze_tree_build(maze_tree* tree, const maze_grid* grid);
+
+// number of steps between two cells
+uint32_t maze_tree_distance(const maze_tree* tree, int start_row, int start_col, int goal_row, int goal_col);
+
+// the path between two cells in O(path length), the start cell is marked as entered heading south
+// like the entrance in solve_maze. returns false when out of memory
+bool maze_tree_path(const maze_tree* tree, int start_row, int start_col, int goal_row, int goal_col, maze_path* path);
+
+// answer count distance queries on num_threads threads, distances[i] is the answer to queries[i]
+void maze_tree_distances(const maze_tree* tree, const maze_query* queries, long long count,
+	uint32_t* distances, int num_threads);
+
+#endif
@@ -1,18 +1,48 @@
-#version 120
+#version 130
 
 attribute vec4 vPosition;
 attribute vec2 vTexCoord;
+// where the instanced path places each copy of a unit cube, zero for vertices that are already placed
+attribute vec3 vInstance;
 
 varying vec2 texCoord;
+varying vec2 tileOffset;
+varying vec3 wallBitsCoord;
 varying float f_use_texture;
 
 uniform mat4 model_view_matrix;
 uniform mat4 projection_matrix;
+// fits the instanced maze to the screen, identity for vertices that are already fit
+uniform mat4 maze_matrix;
+// the mesh stores positions as whole steps from an offset, the other paths use a scale of 1 and no offset
+uniform float position_scale;
+uniform vec3 position_offset;
+// set for the mesh, which counts texture coordinates in whole tiles and keeps the kind of cube in u
+uniform int repeat_tiles;
+// texels across and down the wall bits the far quads of the mesh are colored from
+uniform vec2 wall_bits_size;
 uniform int use_texture;
 
 void main()
 {
+	vec4 decoded = vec4(position_offset + position_scale * vPosition.xyz, vPosition.w);
+
 	texCoord = vTexCoord;
 	f_use_texture = use_texture;
-	gl_Position = model_view_matrix * vPosition;
+	tileOffset = vec2(0.0, 0.0);
+	if (repeat_tiles == 1) {
+		// the quarter of the texture of each kind of cube, the floor, a pole or a wall
+		float kind = floor(vTexCoord.x / 64.0);
+		texCoord.x -= 64.0 * kind;
+		tileOffset = (kind == 0.0) ? vec2(0.0, 0.5) : ((kind == 1.0) ? vec2(0.5, 0.0) : vec2(0.0, 0.0));
+	}
+	// the wall bits have a pole on every other texel starting with the first, rows run along x
+	wallBitsCoord = vec3((2.0 * decoded.yx - 0.5) / wall_bits_size, decoded.z);
+
+	// turn the cube by whole quarter turns, rounded so walls line up exactly
+	float angle = vInstance.z * 1.5707963;
+	vec2 turn = floor(vec2(cos(angle), sin(angle)) + 0.5);
+	vec4 position = vec4(turn.x * decoded.x - turn.y * decoded.y + vInstance.x * decoded.w,
+		turn.y * decoded.x + turn.x * decoded.y + vInstance.y * decoded.w, decoded.z, decoded.w);
+	gl_Position = model_view_matrix * maze_matrix * position;
 }
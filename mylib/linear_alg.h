@@ -1,3 +1,6 @@
+#ifndef _LINEAR_ALG_H_
+#define _LINEAR_ALG_H_
+
 // +----------------------------------------------------------------------+
 // |                                                                      |
 // |                              VEC4                                    |
@@ -106,3 +109,5 @@ mat4 xform_rot_mat(char axis, float a);
 
 
 mat4 look_at(vec4 eye, vec4 at, vec4 up);
+
+#endif